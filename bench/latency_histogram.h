@@ -0,0 +1,153 @@
+//A latency histogram in the style of HdrHistogram. Values below 128 ns get a bucket each,
+//above that every power of two is split into 64 buckets, so a percentile is never off by
+//more than 1/64th of its value however long the tail gets. Recording is a couple of shifts
+//and an increment, cheap enough for the timed loop.
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class LatencyHistogram {
+public:
+    LatencyHistogram() : counts_(BUCKETS, 0) {}
+
+    //Author:      Chris Martinez
+    //Description: Adds one value, in nanoseconds
+    //Date:        16 October 2026
+    //Version:     1.0
+    void record(uint64_t ns) {
+        counts_[index(ns)]++;
+        total_++;
+        if (ns > max_) {
+            max_ = ns;
+        }
+        if (ns < min_) {
+            min_ = ns;
+        }
+        sum_ += ns;
+    }
+
+    //Author:      Chris Martinez
+    //Description: Adds one value the way HdrHistogram's recordValueWithExpectedInterval does.
+    //             A sender that waits for each reply stops sending while one is slow, so it
+    //             never measures the requests that would have been queued up behind it.
+    //             For a value longer than the interval requests were meant to go out at,
+    //             the ones it held up are added too, each one interval less delayed.
+    //Date:        16 October 2026
+    //Version:     1.0
+    void record_corrected(uint64_t ns, uint64_t expected_interval) {
+        record(ns);
+        if (expected_interval == 0) {
+            return;
+        }
+        for (uint64_t missed = ns; missed > expected_interval; ) {
+            missed -= expected_interval;
+            record(missed);
+        }
+    }
+
+    //Author:      Chris Martinez
+    //Description: Adds every value of other, so threads can keep their own and merge at the end
+    //Date:        16 October 2026
+    //Version:     1.0
+    void add(const LatencyHistogram& other) {
+        for (size_t i = 0; i < BUCKETS; i++) {
+            counts_[i] += other.counts_[i];
+        }
+        total_ += other.total_;
+        sum_ += other.sum_;
+        if (other.max_ > max_) {
+            max_ = other.max_;
+        }
+        if (other.min_ < min_) {
+            min_ = other.min_;
+        }
+    }
+
+    //Author:      Chris Martinez
+    //Description: Returns a copy with every value re-recorded with record_corrected,
+    //             like HdrHistogram's copyCorrectedForCoordinatedOmission
+    //Date:        16 October 2026
+    //Version:     1.0
+    LatencyHistogram corrected(uint64_t expected_interval) const {
+        LatencyHistogram copy;
+
+        for (size_t i = 0; i < BUCKETS; i++) {
+            for (uint64_t n = 0; n < counts_[i]; n++) {
+                copy.record_corrected(value(i) < max_ ? value(i) : max_, expected_interval);
+            }
+        }
+        return copy;
+    }
+
+    //Author:      Chris Martinez
+    //Description: Returns the value at or below which percent of the values fall, reported as
+    //             the top of its bucket. 100 gives the exact max.
+    //Date:        16 October 2026
+    //Version:     1.0
+    uint64_t percentile(double percent) const {
+        uint64_t want = (uint64_t)(percent / 100.0 * total_ + 0.5);
+        uint64_t seen = 0;
+
+        if (total_ == 0) {
+            return 0;
+        }
+        if (want == 0) {
+            want = 1;
+        }
+        for (size_t i = 0; i < BUCKETS; i++) {
+            seen += counts_[i];
+            if (seen >= want) {
+                return value(i) < max_ ? value(i) : max_;
+            }
+        }
+        return max_;
+    }
+
+    uint64_t count() const { return total_; }
+    uint64_t min() const { return total_ != 0 ? min_ : 0; }
+    uint64_t max() const { return max_; }
+    double mean() const { return total_ != 0 ? (double)sum_ / total_ : 0; }
+
+private:
+    static const unsigned LINEAR = 128;  //Values below this each get a bucket
+    static const unsigned SUB_BITS = 6;  //Every power of two past that is split 1 << SUB_BITS ways
+    static const size_t BUCKETS = LINEAR + (64 - 7) * (1u << SUB_BITS);
+
+    //Author:      Chris Martinez
+    //Description: Returns the bucket a value goes in
+    //Date:        16 October 2026
+    //Version:     1.0
+    static size_t index(uint64_t ns) {
+        if (ns < LINEAR) {
+            return ns;
+        }
+        unsigned exp = 63 - __builtin_clzll(ns);
+        unsigned shift = exp - SUB_BITS;
+        return LINEAR + (exp - 7) * (1u << SUB_BITS) + ((ns >> shift) - (1u << SUB_BITS));
+    }
+
+    //Author:      Chris Martinez
+    //Description: Returns the highest value that goes in a bucket
+    //Date:        16 October 2026
+    //Version:     1.0
+    static uint64_t value(size_t i) {
+        if (i < LINEAR) {
+            return i;
+        }
+        unsigned exp = (i - LINEAR) / (1u << SUB_BITS) + 7;
+        uint64_t mantissa = (i - LINEAR) % (1u << SUB_BITS) + (1u << SUB_BITS);
+        unsigned shift = exp - SUB_BITS;
+        return ((mantissa + 1) << shift) - 1;
+    }
+
+    std::vector<uint64_t> counts_;
+    uint64_t total_ = 0;
+    uint64_t min_ = UINT64_MAX;
+    uint64_t max_ = 0;
+    uint64_t sum_ = 0;
+};
+
+#endif
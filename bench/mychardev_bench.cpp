@@ -0,0 +1,805 @@
+//Throughput benchmark for mychardev. Producer threads write messages of a fixed size into
+//one device while consumer threads read them back out, and one CSV row is printed for every
+//message size swept. Every consumer gets every record, the device broadcasts, so messages
+//read counts each message once per consumer.
+//
+//The same workload, with the same message sizes and threads, also runs over a pipe, a Unix
+//stream socket, a POSIX message queue and an eventfd, and all of them go in one table to
+//compare against. Those hand each message to just one of the consumers, so compare them
+//with one consumer. An eventfd only carries an 8 byte count, so it only runs at 8 bytes,
+//and a message queue only runs up to /proc/sys/fs/mqueue/msgsize_max.
+//
+//A message bigger than the device's ring goes in as several records, load the module with
+//a buf_len big enough for the largest size swept to measure whole messages.
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <mqueue.h>
+#include <poll.h>
+#include <sched.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "mychardev.h"
+
+#define SUCCESSFUL          0
+#define MAX_IOV             64
+
+enum class Api {
+    ReadWrite, //One read or write per message
+    Vector,    //readv and writev with batch messages per call
+};
+
+struct Options {
+    std::string             dev = "/dev/mychardev";
+    std::vector<std::string> transports = { "mychardev" };
+    unsigned int            producers = 1;
+    unsigned int            consumers = 1;
+    std::vector<size_t>     sizes;
+    Api                     api = Api::ReadWrite;
+    unsigned int            batch = 8;
+    double                  seconds = 2.0;
+    unsigned int            policy = MYCHARDEV_POLICY_BLOCK;
+    std::string             scale;        //Which count the scaling sweep steps up, empty for no sweep
+    unsigned int            scale_max = 0;
+    std::vector<int>        cpus;         //Threads are pinned to these in turn, producers first
+};
+
+struct Result {
+    double                  seconds = 0;
+    uint64_t                bytes_written = 0;
+    uint64_t                bytes_read = 0;
+    uint64_t                lost = 0;
+    double                  cpu_seconds = 0;
+};
+
+//One kind of channel the workload runs over. Producers and consumers each get their own
+//descriptor, consumers' are non blocking so they can tell when the run is over.
+class Transport {
+public:
+    virtual ~Transport() {}
+
+    //Author:      Chris Martinez
+    //Description: Gets ready for one run with messages of size bytes. Returns false when the
+    //             transport cannot carry messages that size, and the size is skipped.
+    //Date:        16 October 2026
+    //Version:     1.0
+    virtual bool setup(size_t) { return true; }
+    virtual void teardown() {}
+    virtual int open_producer() = 0;
+    virtual int open_consumer() = 0;
+
+    //Author:      Chris Martinez
+    //Description: Sends and receives like write and read. Transports without readv and writev
+    //             are never given more than one message at a time.
+    //Date:        16 October 2026
+    //Version:     1.0
+    virtual ssize_t send(int fd, const char* buf, size_t len) { return write(fd, buf, len); }
+    virtual ssize_t recv(int fd, char* buf, size_t len) { return read(fd, buf, len); }
+    virtual bool vectored() const { return true; }
+
+    //Author:      Chris Martinez
+    //Description: Returns how many messages the consumer on fd lost, for the ones that can lose them
+    //Date:        16 October 2026
+    //Version:     1.0
+    virtual uint64_t lost(int) { return 0; }
+    virtual const char* api(Api api) const { return api == Api::Vector ? "readv" : "rw"; }
+};
+
+//The device itself, opened once by every thread
+class DevTransport : public Transport {
+public:
+    explicit DevTransport(const std::string& dev) : dev_(dev) {}
+
+    int open_producer() override { return open(dev_.c_str(), O_WRONLY); }
+    int open_consumer() override { return open(dev_.c_str(), O_RDONLY | O_NONBLOCK); }
+
+    uint64_t lost(int fd) override {
+        struct mychardev_reader_info info = {};
+
+        if (ioctl(fd, IOCTL_GET_READER_INFO, &info) != SUCCESSFUL) {
+            return 0;
+        }
+        return info.lost;
+    }
+
+private:
+    std::string dev_;
+};
+
+//A pipe or a Unix stream socket, each thread gets a dup of the end it uses
+class PairTransport : public Transport {
+public:
+    explicit PairTransport(bool socket) : socket_(socket) {}
+
+    bool setup(size_t) override {
+        int ret = socket_ ? socketpair(AF_UNIX, SOCK_STREAM, 0, fds_) : pipe(fds_);
+
+        if (ret != SUCCESSFUL) {
+            perror("mychardev_bench: pipe");
+            exit(EXIT_FAILURE);
+        }
+        fcntl(fds_[0], F_SETFL, O_NONBLOCK);
+        return true;
+    }
+
+    void teardown() override {
+        close(fds_[0]);
+        close(fds_[1]);
+    }
+
+    int open_producer() override { return dup(fds_[1]); }
+    int open_consumer() override { return dup(fds_[0]); }
+
+private:
+    bool socket_;
+    int fds_[2];
+};
+
+//A POSIX message queue, one message per mq_send
+class MqueueTransport : public Transport {
+public:
+    MqueueTransport() : name_("/mychardev_bench." + std::to_string(getpid())) {}
+
+    bool setup(size_t size) override {
+        struct mq_attr attr = {};
+        mqd_t mq;
+
+        attr.mq_maxmsg = 10; //the most an unprivileged queue gets by default
+        attr.mq_msgsize = size;
+        mq = mq_open(name_.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600, &attr);
+        if (mq == (mqd_t)-1) {
+            fprintf(stderr, "mychardev_bench: mqueue cannot take %zu byte messages: %s\n", size, strerror(errno));
+            return false;
+        }
+        mq_close(mq);
+        return true;
+    }
+
+    void teardown() override { mq_unlink(name_.c_str()); }
+    int open_producer() override { return mq_open(name_.c_str(), O_WRONLY); }
+    int open_consumer() override { return mq_open(name_.c_str(), O_RDONLY | O_NONBLOCK); }
+
+    ssize_t send(int fd, const char* buf, size_t len) override {
+        return mq_send(fd, buf, len, 0) == SUCCESSFUL ? (ssize_t)len : -1;
+    }
+    ssize_t recv(int fd, char* buf, size_t len) override { return mq_receive(fd, buf, len, nullptr); }
+    bool vectored() const override { return false; }
+    const char* api(Api) const override { return "mq"; }
+
+private:
+    std::string name_;
+};
+
+//An eventfd, where a message is adding 1 to the count and reading takes all of them
+class EventfdTransport : public Transport {
+public:
+    bool setup(size_t size) override {
+        if (size != sizeof(uint64_t)) {
+            return false;
+        }
+        fd_ = eventfd(0, EFD_NONBLOCK);
+        if (fd_ < 0) {
+            perror("mychardev_bench: eventfd");
+            exit(EXIT_FAILURE);
+        }
+        return true;
+    }
+
+    void teardown() override { close(fd_); }
+    int open_producer() override { return dup(fd_); }
+    int open_consumer() override { return dup(fd_); }
+
+    ssize_t send(int fd, const char*, size_t len) override {
+        uint64_t one = 1;
+        return write(fd, &one, sizeof(one)) == sizeof(one) ? (ssize_t)len : -1;
+    }
+
+    ssize_t recv(int fd, char*, size_t) override {
+        uint64_t count;
+        return read(fd, &count, sizeof(count)) == sizeof(count) ? (ssize_t)(count * sizeof(count)) : -1;
+    }
+
+    bool vectored() const override { return false; }
+    const char* api(Api) const override { return "eventfd"; }
+
+private:
+    int fd_;
+};
+
+//Author:      Chris Martinez
+//Description: Makes the transport with this name, or returns nullptr if there is none
+//Date:        16 October 2026
+//Version:     1.0
+static std::unique_ptr<Transport> make_transport(const std::string& name, const Options& opts) {
+    if (name == "mychardev") {
+        return std::unique_ptr<Transport>(new DevTransport(opts.dev));
+    } else if (name == "pipe") {
+        return std::unique_ptr<Transport>(new PairTransport(false));
+    } else if (name == "unix") {
+        return std::unique_ptr<Transport>(new PairTransport(true));
+    } else if (name == "mqueue") {
+        return std::unique_ptr<Transport>(new MqueueTransport());
+    } else if (name == "eventfd") {
+        return std::unique_ptr<Transport>(new EventfdTransport());
+    }
+    return nullptr;
+}
+
+//Shared by the threads of one run
+struct Run {
+    const Options*          opts;
+    Transport*              transport;
+    size_t                  size;
+    std::atomic<unsigned>   ready{0};
+    std::atomic<bool>       go{false};
+    std::atomic<bool>       stop{false};
+    std::atomic<unsigned>   producers_done{0};
+    std::atomic<uint64_t>   bytes_written{0};
+    std::atomic<uint64_t>   bytes_read{0};
+    std::atomic<uint64_t>   lost{0};
+};
+
+//Author:      Chris Martinez
+//Description: Returns the CPU time the whole process has used, user and system, in seconds
+//Date:        16 October 2026
+//Version:     1.0
+static double cpu_time() {
+    struct rusage usage;
+
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec +
+           (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+//Author:      Chris Martinez
+//Description: Pins the calling thread to one CPU, a negative cpu leaves it unpinned
+//Date:        16 October 2026
+//Version:     1.0
+static void pin_thread(int cpu) {
+    cpu_set_t set;
+
+    if (cpu < 0) {
+        return;
+    }
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if (sched_setaffinity(0, sizeof(set), &set) != SUCCESSFUL) {
+        perror("mychardev_bench: sched_setaffinity");
+        exit(EXIT_FAILURE);
+    }
+}
+
+//Author:      Chris Martinez
+//Description: Waits at the start line until every thread of the run is there
+//Date:        16 October 2026
+//Version:     1.0
+static void start_line(Run* run) {
+    run->ready.fetch_add(1);
+    while (!run->go.load(std::memory_order_acquire)) {
+        std::this_thread::yield();
+    }
+}
+
+//Author:      Chris Martinez
+//Description: Writes messages of run->size until the run is stopped. A message the device
+//             only takes part of is finished before the next one starts.
+//             The thread is pinned to cpu before it touches its buffer, so the buffer is
+//             allocated on that CPU's NUMA node.
+//Date:        16 October 2026
+//Version:     1.1
+static void producer(Run* run, int cpu) {
+    pin_thread(cpu);
+
+    const Options* opts = run->opts;
+    Transport* transport = run->transport;
+    unsigned int batch = opts->api == Api::Vector && transport->vectored() ? opts->batch : 1;
+    std::vector<char> buf(run->size * batch, 'x');
+    struct iovec iov[MAX_IOV];
+    uint64_t written = 0;
+    int fd = transport->open_producer();
+
+    if (fd < 0) {
+        perror("mychardev_bench: open for writing");
+        exit(EXIT_FAILURE);
+    }
+    for (unsigned int i = 0; i < batch; i++) {
+        iov[i].iov_base = &buf[i * run->size];
+        iov[i].iov_len = run->size;
+    }
+
+    start_line(run);
+    while (!run->stop.load(std::memory_order_relaxed)) {
+        size_t left = run->size * batch;
+
+        while (left > 0) {
+            ssize_t ret;
+
+            if (batch > 1 && left == run->size * batch) {
+                ret = writev(fd, iov, batch);
+            } else {
+                ret = transport->send(fd, &buf[buf.size() - left], left);
+            }
+            if (ret < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                perror("mychardev_bench: write");
+                exit(EXIT_FAILURE);
+            }
+            left -= ret;
+            written += ret;
+        }
+    }
+
+    close(fd);
+    run->bytes_written.fetch_add(written);
+    run->producers_done.fetch_add(1);
+}
+
+//Author:      Chris Martinez
+//Description: Reads until the producers are done and the device has nothing left for this
+//             consumer, then adds up what it read and what it lost to the run. Pinned the
+//             same way as the producers.
+//Date:        16 October 2026
+//Version:     1.1
+static void consumer(Run* run, int cpu) {
+    pin_thread(cpu);
+
+    const Options* opts = run->opts;
+    Transport* transport = run->transport;
+    unsigned int batch = opts->api == Api::Vector && transport->vectored() ? opts->batch : 1;
+    std::vector<char> buf(run->size * batch);
+    struct iovec iov[MAX_IOV];
+    uint64_t read_bytes = 0;
+    int fd = transport->open_consumer();
+
+    if (fd < 0) {
+        perror("mychardev_bench: open for reading");
+        exit(EXIT_FAILURE);
+    }
+    for (unsigned int i = 0; i < batch; i++) {
+        iov[i].iov_base = &buf[i * run->size];
+        iov[i].iov_len = run->size;
+    }
+
+    start_line(run);
+    for (;;) {
+        ssize_t ret;
+
+        if (batch > 1) {
+            ret = readv(fd, iov, batch);
+        } else {
+            ret = transport->recv(fd, buf.data(), buf.size());
+        }
+        if (ret > 0) {
+            read_bytes += ret;
+            continue;
+        }
+        if (ret < 0 && errno != EAGAIN && errno != EINTR) {
+            perror("mychardev_bench: read");
+            exit(EXIT_FAILURE);
+        }
+
+        //Nothing to read, or the end of a pipe whose producers all closed.
+        //Once every producer is done that means the run is over.
+        if (run->producers_done.load() == opts->producers) {
+            break;
+        }
+        struct pollfd pfd = { fd, POLLIN, 0 };
+        poll(&pfd, 1, 100);
+    }
+
+    run->lost.fetch_add(transport->lost(fd));
+    close(fd);
+    run->bytes_read.fetch_add(read_bytes);
+}
+
+//Author:      Chris Martinez
+//Description: Returns the CPU the thread with this index gets, or -1 when not pinning
+//Date:        16 October 2026
+//Version:     1.0
+static int cpu_for(const Options& opts, unsigned int index) {
+    if (opts.cpus.empty()) {
+        return -1;
+    }
+    return opts.cpus[index % opts.cpus.size()];
+}
+
+//Author:      Chris Martinez
+//Description: Runs the producers and consumers for one message size over one transport
+//             and returns the totals
+//Date:        16 October 2026
+//Version:     1.2
+static Result run_size(const Options& opts, Transport* transport, size_t size) {
+    Run run;
+    std::vector<std::thread> threads;
+    Result result;
+
+    run.opts = &opts;
+    run.transport = transport;
+    run.size = size;
+
+    //Consumers open first, so they are there for the first record.
+    //CPUs go to the producers first, then the consumers.
+    for (unsigned int i = 0; i < opts.consumers; i++) {
+        threads.emplace_back(consumer, &run, cpu_for(opts, opts.producers + i));
+    }
+    for (unsigned int i = 0; i < opts.producers; i++) {
+        threads.emplace_back(producer, &run, cpu_for(opts, i));
+    }
+    while (run.ready.load() != threads.size()) {
+        std::this_thread::yield();
+    }
+
+    double cpu_start = cpu_time();
+    auto start = std::chrono::steady_clock::now();
+    run.go.store(true, std::memory_order_release);
+    std::this_thread::sleep_for(std::chrono::duration<double>(opts.seconds));
+    run.stop.store(true);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    result.seconds = std::chrono::duration<double>(end - start).count();
+    result.cpu_seconds = cpu_time() - cpu_start;
+    result.bytes_written = run.bytes_written.load();
+    result.bytes_read = run.bytes_read.load();
+    result.lost = run.lost.load();
+    return result;
+}
+
+//Author:      Chris Martinez
+//Description: Splits a comma separated list
+//Date:        16 October 2026
+//Version:     1.0
+static std::vector<std::string> split(const char* arg) {
+    std::vector<std::string> items;
+    std::string list(arg);
+    size_t pos = 0;
+
+    for (;;) {
+        size_t comma = list.find(',', pos);
+
+        items.push_back(list.substr(pos, comma == std::string::npos ? std::string::npos : comma - pos));
+        if (comma == std::string::npos) {
+            return items;
+        }
+        pos = comma + 1;
+    }
+}
+
+//Author:      Chris Martinez
+//Description: Parses a comma separated list of sizes, each optionally ending in k or m
+//Date:        16 October 2026
+//Version:     1.1
+static std::vector<size_t> parse_sizes(const char* arg) {
+    std::vector<size_t> sizes;
+
+    for (const std::string& item : split(arg)) {
+        char* end;
+        size_t size = strtoul(item.c_str(), &end, 0);
+
+        if (*end == 'k' || *end == 'K') {
+            size <<= 10;
+        } else if (*end == 'm' || *end == 'M') {
+            size <<= 20;
+        }
+        if (size == 0) {
+            fprintf(stderr, "mychardev_bench: bad size '%s'\n", item.c_str());
+            exit(EXIT_FAILURE);
+        }
+        sizes.push_back(size);
+    }
+    return sizes;
+}
+
+//Author:      Chris Martinez
+//Description: Parses a CPU list the way the kernel prints them, like 0-3,8,10-11
+//Date:        16 October 2026
+//Version:     1.0
+static std::vector<int> parse_cpus(const std::string& list) {
+    std::vector<int> cpus;
+
+    for (const std::string& item : split(list.c_str())) {
+        int first, last;
+        int n = sscanf(item.c_str(), "%d-%d", &first, &last);
+
+        if (n < 1) {
+            continue;
+        }
+        for (int cpu = first; cpu <= (n == 2 ? last : first); cpu++) {
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+
+//Author:      Chris Martinez
+//Description: Returns the CPUs of a NUMA node, empty if there is no such node
+//Date:        16 October 2026
+//Version:     1.0
+static std::vector<int> node_cpus(int node) {
+    std::string path = "/sys/devices/system/node/node" + std::to_string(node) + "/cpulist";
+    char line[4096] = "";
+    FILE* file = fopen(path.c_str(), "r");
+
+    if (file == nullptr) {
+        return std::vector<int>();
+    }
+    if (fgets(line, sizeof(line), file) == nullptr) {
+        line[0] = '\0';
+    }
+    fclose(file);
+    line[strcspn(line, "\n")] = '\0';
+    return parse_cpus(line);
+}
+
+//Author:      Chris Martinez
+//Description: Turns the NUMA placement asked for into the list of CPUs threads are pinned to.
+//             A node number keeps every thread on that node. spread takes a CPU from each
+//             node in turn, so the threads and their buffers go across every node.
+//Date:        16 October 2026
+//Version:     1.0
+static std::vector<int> numa_cpus(const char* placement) {
+    std::vector<std::vector<int>> nodes;
+    std::vector<int> cpus;
+
+    if (strcmp(placement, "spread") != 0) {
+        cpus = node_cpus(strtol(placement, nullptr, 0));
+        if (cpus.empty()) {
+            fprintf(stderr, "mychardev_bench: no CPUs on NUMA node %s\n", placement);
+            exit(EXIT_FAILURE);
+        }
+        return cpus;
+    }
+
+    for (int node = 0; ; node++) {
+        std::vector<int> list = node_cpus(node);
+        if (list.empty()) {
+            break;
+        }
+        nodes.push_back(list);
+    }
+    for (size_t i = 0; !nodes.empty(); i++) {
+        bool any = false;
+
+        for (const std::vector<int>& list : nodes) {
+            if (i < list.size()) {
+                cpus.push_back(list[i]);
+                any = true;
+            }
+        }
+        if (!any) {
+            break;
+        }
+    }
+    return cpus;
+}
+
+//Author:      Chris Martinez
+//Description: Prints how to run the benchmark
+//Date:        16 October 2026
+//Version:     1.1
+static void usage(const char* prog) {
+    fprintf(stderr,
+            "usage: %s [options]\n"
+            "  -d DEV     device to drive (default /dev/mychardev)\n"
+            "  -T LIST    transports out of mychardev, pipe, unix, mqueue and eventfd, or all\n"
+            "             (default mychardev)\n"
+            "  -p N       producer threads (default 1)\n"
+            "  -c N       consumer threads (default 1)\n"
+            "  -s LIST    message sizes, e.g. 8,64,4k,1m (default 8 B to 512 KiB in powers of 4, then 1 MiB)\n"
+            "  -a API     rw for read and write, readv for readv and writev (default rw)\n"
+            "  -b N       messages per readv and writev call (default 8, at most %d)\n"
+            "  -t SECS    how long each size runs (default 2)\n"
+            "  -P POLICY  overflow policy for the run: overwrite, drop or block (default block)\n"
+            "  -S COUNT   scaling sweep: step producers, consumers or both from 1 up to -m\n"
+            "  -m N       where the scaling sweep stops (default the number of online CPUs)\n"
+            "  -A LIST    CPUs to pin threads to in turn, producers first, like 0-3,8\n"
+            "  -N NODE    pin threads to the CPUs of one NUMA node, or spread them across nodes\n"
+            "             with -N spread. Buffers are allocated on the node of their thread.\n"
+            "The batch ioctl and mmap APIs are not offered, mychardev has neither.\n",
+            prog, MAX_IOV);
+}
+
+//Author:      Chris Martinez
+//Description: Sets the device's overflow policy and returns the one it had, or -1 if the
+//             device does not take the ioctls. The file is only open for the ioctls, as the
+//             spsc build lets just one writer have the device open.
+//Date:        16 October 2026
+//Version:     1.0
+static int set_policy(const std::string& dev, int policy) {
+    int fd = open(dev.c_str(), O_WRONLY);
+    int old;
+
+    if (fd < 0) {
+        perror("mychardev_bench: open");
+        exit(EXIT_FAILURE);
+    }
+    old = ioctl(fd, IOCTL_GET_POLICY);
+    if (old < 0 || ioctl(fd, IOCTL_SET_POLICY, policy) != SUCCESSFUL) {
+        fprintf(stderr, "mychardev_bench: cannot set the policy of %s (%s), running with its own\n",
+                dev.c_str(), strerror(errno));
+        old = -1;
+    }
+    close(fd);
+    return old;
+}
+
+//Author:      Chris Martinez
+//Description: Sweeps the message sizes over every transport with the thread counts in opts,
+//             printing one CSV row for each
+//Date:        16 October 2026
+//Version:     1.0
+static void run_sizes(const Options& opts, const std::vector<std::unique_ptr<Transport>>& transports) {
+    for (size_t size : opts.sizes) {
+        for (size_t i = 0; i < transports.size(); i++) {
+            Transport* transport = transports[i].get();
+
+            if (!transport->setup(size)) {
+                continue;
+            }
+            Result result = run_size(opts, transport, size);
+            double msgs_read = (double)result.bytes_read / size;
+            transport->teardown();
+
+            printf("%s,%s,%u,%u,%zu,%.3f,%llu,%llu,%llu,%.0f,%.3f,%.0f\n",
+                   opts.transports[i].c_str(), transport->api(opts.api), opts.producers, opts.consumers, size,
+                   result.seconds, (unsigned long long)(result.bytes_written / size),
+                   (unsigned long long)(result.bytes_read / size), (unsigned long long)result.lost,
+                   msgs_read / result.seconds, result.bytes_read / result.seconds / 1e9,
+                   msgs_read > 0 ? result.cpu_seconds * 1e9 / msgs_read : 0.0);
+            fflush(stdout);
+        }
+    }
+}
+
+//Author:      Chris Martinez
+//Description: Parses the options, sets the device's policy for the run, sweeps the message
+//             sizes and prints one CSV row per size and transport, so every transport's row
+//             for a size sits together. With -S that is repeated for every thread count.
+//             The device's policy is put back after.
+//Date:        16 October 2026
+//Version:     1.3
+int main(int argc, char** argv) {
+    Options opts;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "d:T:p:c:s:a:b:t:P:S:m:A:N:h")) != -1) {
+        switch (opt) {
+            case 'd':
+                opts.dev = optarg;
+                break;
+            case 'T':
+                if (strcmp(optarg, "all") == 0) {
+                    opts.transports = { "mychardev", "pipe", "unix", "mqueue", "eventfd" };
+                } else {
+                    opts.transports = split(optarg);
+                }
+                break;
+            case 'p':
+                opts.producers = strtoul(optarg, nullptr, 0);
+                break;
+            case 'c':
+                opts.consumers = strtoul(optarg, nullptr, 0);
+                break;
+            case 's':
+                opts.sizes = parse_sizes(optarg);
+                break;
+            case 'a':
+                if (strcmp(optarg, "rw") == 0) {
+                    opts.api = Api::ReadWrite;
+                } else if (strcmp(optarg, "readv") == 0) {
+                    opts.api = Api::Vector;
+                } else {
+                    fprintf(stderr, "mychardev_bench: unsupported api '%s'\n", optarg);
+                    usage(argv[0]);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'b':
+                opts.batch = strtoul(optarg, nullptr, 0);
+                break;
+            case 't':
+                opts.seconds = strtod(optarg, nullptr);
+                break;
+            case 'P':
+                if (strcmp(optarg, "overwrite") == 0) {
+                    opts.policy = MYCHARDEV_POLICY_OVERWRITE;
+                } else if (strcmp(optarg, "drop") == 0) {
+                    opts.policy = MYCHARDEV_POLICY_DROP;
+                } else if (strcmp(optarg, "block") == 0) {
+                    opts.policy = MYCHARDEV_POLICY_BLOCK;
+                } else {
+                    usage(argv[0]);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'S':
+                opts.scale = optarg;
+                if (opts.scale != "producers" && opts.scale != "consumers" && opts.scale != "both") {
+                    usage(argv[0]);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'm':
+                opts.scale_max = strtoul(optarg, nullptr, 0);
+                break;
+            case 'A':
+                opts.cpus = parse_cpus(optarg);
+                break;
+            case 'N':
+                opts.cpus = numa_cpus(optarg);
+                break;
+            default:
+                usage(argv[0]);
+                return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+    if (opts.producers == 0 || opts.consumers == 0 || opts.batch == 0 || opts.batch > MAX_IOV ||
+        opts.seconds <= 0) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (opts.scale_max == 0) {
+        opts.scale_max = sysconf(_SC_NPROCESSORS_ONLN);
+    }
+    if (opts.sizes.empty()) {
+        for (size_t size = 8; size < (1 << 20); size *= 4) {
+            opts.sizes.push_back(size);
+        }
+        opts.sizes.push_back(1 << 20); //8 times a power of 4 never lands on it
+    }
+
+    std::vector<std::unique_ptr<Transport>> transports;
+    for (const std::string& name : opts.transports) {
+        transports.push_back(make_transport(name, opts));
+        if (transports.back() == nullptr) {
+            fprintf(stderr, "mychardev_bench: unknown transport '%s'\n", name.c_str());
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    //The policy belongs to the device, so it outlasts the file it is set through and is put back after
+    int old_policy = -1;
+    if (std::find(opts.transports.begin(), opts.transports.end(), "mychardev") != opts.transports.end()) {
+        old_policy = set_policy(opts.dev, opts.policy);
+    }
+
+    printf("transport,api,producers,consumers,msg_bytes,seconds,msgs_written,msgs_read,lost,msgs_per_s,gb_per_s,cpu_ns_per_msg\n");
+    for (unsigned int count = 1; count <= (opts.scale.empty() ? 1 : opts.scale_max); count++) {
+        Options run_opts = opts;
+
+        //Without a sweep this runs once, with -p and -c as they are
+        if (opts.scale == "producers" || opts.scale == "both") {
+            run_opts.producers = count;
+        }
+        if (opts.scale == "consumers" || opts.scale == "both") {
+            run_opts.consumers = count;
+        }
+        run_sizes(run_opts, transports);
+    }
+
+    if (old_policy >= 0) {
+        set_policy(opts.dev, old_policy);
+    }
+    return EXIT_SUCCESS;
+}
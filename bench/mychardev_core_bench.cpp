@@ -0,0 +1,267 @@
+//Google Benchmark microbenchmarks of the driver's ring and record code, built in userspace from
+//mychardev_core.h. They time the enqueue and dequeue paths in ns/op with no syscalls in the way,
+//so a change to the core can be measured in seconds without loading the module or being root.
+//The copies to and from "user" memory are plain memcpys here, so these numbers are a floor
+//under what the device can do, not a prediction of it.
+#include <benchmark/benchmark.h>
+
+#include <cstdlib>
+#include <vector>
+
+extern "C" {
+#include "mychardev_core.h"
+}
+
+namespace {
+
+const size_t RING_LEN = 1 << 20;
+
+//A ring with its own buffer and one reader, set up the way dev_init and dev_open leave them
+struct CoreRing {
+    std::vector<char> buf;
+    struct dev_ring ring;
+    struct dev_cursor cur;
+
+    explicit CoreRing(size_t len) : buf(len) {
+        memset(&ring, 0, sizeof(ring));
+        memset(&cur, 0, sizeof(cur));
+        ring.buf = buf.data();
+        ring.len = len;
+        dev_cursor_init(&cur, &ring);
+    }
+};
+
+//Author:      Chris Martinez
+//Description: Stands in for dev_reader_account, so the reads pay for the same callback
+//Date:        16 October 2026
+//Version:     1.0
+void count_taken(void* ctx, const struct mychardev_rec_hdr* hdr) {
+    *(uint64_t*)ctx += hdr->len;
+}
+
+//Author:      Chris Martinez
+//Description: Queues records of state.range(0) bytes into a ring that is always full, so
+//             every push also discards the oldest record, as OVERWRITE does
+//Date:        16 October 2026
+//Version:     1.0
+void BM_Push(benchmark::State& state) {
+    size_t msg = state.range(0);
+    CoreRing r(RING_LEN);
+    std::vector<char> src(msg, 'x');
+    u64 seq;
+
+    for (auto _ : state) {
+        dev_ring_make_room(&r.ring, dev_rec_size(msg), r.ring.head, true);
+        dev_ring_push(&r.ring, src.data(), msg, 0, &seq);
+        benchmark::DoNotOptimize(seq);
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * msg);
+}
+
+//Author:      Chris Martinez
+//Description: Queues one record of state.range(0) bytes and reads it straight back,
+//             with a stream read or, when state.range(1) is set, a records read
+//Date:        16 October 2026
+//Version:     1.0
+void BM_PushRead(benchmark::State& state) {
+    size_t msg = state.range(0);
+    bool records = state.range(1) != 0;
+    CoreRing r(RING_LEN);
+    std::vector<char> src(msg, 'x');
+    std::vector<char> dst(dev_rec_size(msg));
+    uint64_t taken = 0;
+    u64 seq;
+    ssize_t got;
+
+    for (auto _ : state) {
+        dev_ring_make_room(&r.ring, dev_rec_size(msg), r.cur.pos, false);
+        dev_ring_push(&r.ring, src.data(), msg, 0, &seq);
+        if (records) {
+            got = dev_ring_read_records(&r.ring, &r.cur, dst.data(), dst.size(), count_taken, &taken);
+        } else {
+            got = dev_ring_read_stream(&r.ring, &r.cur, dst.data(), msg, count_taken, &taken);
+        }
+        benchmark::DoNotOptimize(got);
+    }
+    if (taken != state.iterations() * msg) {
+        state.SkipWithError("reader missed records");
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * msg);
+}
+
+//Author:      Chris Martinez
+//Description: Fills the ring with state.range(0) byte records and drains it with records
+//             reads of state.range(1) bytes, so a read takes many records in one copy
+//Date:        16 October 2026
+//Version:     1.0
+void BM_DrainRecords(benchmark::State& state) {
+    size_t msg = state.range(0);
+    CoreRing r(RING_LEN);
+    std::vector<char> src(msg, 'x');
+    std::vector<char> dst(state.range(1));
+    uint64_t taken = 0;
+    uint64_t msgs = 0;
+    u64 seq;
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        dev_ring_clear(&r.ring);
+        dev_cursor_sync(&r.cur, &r.ring);
+        while (dev_ring_make_room(&r.ring, dev_rec_size(msg), 0, false) == SUCCESSFUL) {
+            dev_ring_push(&r.ring, src.data(), msg, 0, &seq);
+        }
+        msgs += (r.ring.head - r.ring.tail) / dev_rec_size(msg);
+        state.ResumeTiming();
+
+        //dev_do_read only reads when there is something to, so the loop does the same
+        while (r.cur.pos < r.ring.head) {
+            dev_ring_read_records(&r.ring, &r.cur, dst.data(), dst.size(), count_taken, &taken);
+        }
+    }
+    state.SetItemsProcessed(msgs);
+    state.SetBytesProcessed(msgs * msg);
+}
+
+//A ring every thread of BM_LockedPushRead shares, with the lock the device would hold
+struct SharedRing {
+    CoreRing r{RING_LEN};
+    struct mutex lock;
+
+    SharedRing() { mutex_init(&lock); }
+};
+
+SharedRing* shared;
+
+//Author:      Chris Martinez
+//Description: One writer and one reader per pair of threads sharing a ring behind a mutex,
+//             the way the locked device is used. Shows what the lock costs as threads pile up.
+//Date:        16 October 2026
+//Version:     1.0
+void BM_LockedPushRead(benchmark::State& state) {
+    size_t msg = state.range(0);
+    std::vector<char> src(msg, 'x');
+    std::vector<char> dst(msg);
+    u64 seq;
+
+    if (state.thread_index() == 0) {
+        shared = new SharedRing;
+    }
+    for (auto _ : state) {
+        mutex_lock(&shared->lock);
+        if (state.thread_index() % 2 == 0) {
+            dev_ring_make_room(&shared->r.ring, dev_rec_size(msg), shared->r.ring.head, true);
+            dev_ring_push(&shared->r.ring, src.data(), msg, 0, &seq);
+        } else {
+            dev_cursor_sync(&shared->r.cur, &shared->r.ring);
+            dev_ring_read_stream(&shared->r.ring, &shared->r.cur, dst.data(), msg, NULL, NULL);
+        }
+        mutex_unlock(&shared->lock);
+    }
+    if (state.thread_index() == 0) {
+        delete shared;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+//The spsc device's ring: the writer has a lock of its own and the reader the device's, and
+//all the writer looks at to find room is how far the reader has published it got
+struct SplitRing {
+    CoreRing r{RING_LEN};
+    struct mutex wlock;
+    struct mutex lock;
+
+    SplitRing() {
+        mutex_init(&wlock);
+        mutex_init(&lock);
+    }
+};
+
+SplitRing* split;
+
+//What the reader of BM_SplitPushRead checks every record against
+struct SplitCheck {
+    u64 next_seq = 0;
+    uint64_t taken = 0;
+    bool torn = false;
+};
+
+//Author:      Chris Martinez
+//Description: Checks the records a read of BM_SplitPushRead copied out came through whole
+//             and in order. The writer puts each record's seq in its first bytes, so a
+//             record overwritten while it was being copied shows up.
+//Date:        16 October 2026
+//Version:     1.0
+void check_records(SplitCheck* check, const char* buf, ssize_t len) {
+    ssize_t off = 0;
+
+    while (off < len) {
+        const struct mychardev_rec_hdr* hdr = (const struct mychardev_rec_hdr*)(buf + off);
+        u64 seq;
+
+        memcpy(&seq, hdr + 1, sizeof(seq));
+        if (hdr->seq != check->next_seq || seq != hdr->seq) {
+            check->torn = true;
+        }
+        check->next_seq = hdr->seq + 1;
+        check->taken++;
+        off += dev_rec_size(hdr->len);
+    }
+}
+
+//Author:      Chris Martinez
+//Description: One writer and one reader on a ring with a lock each, the way the spsc device
+//             runs them. The writer only drops records the reader has published as read,
+//             and a full ring makes it try again, as a non blocking write under DROP or
+//             BLOCK would. Compare with BM_LockedPushRead at two threads.
+//Date:        16 October 2026
+//Version:     1.1
+void BM_SplitPushRead(benchmark::State& state) {
+    size_t msg = state.range(0);
+    std::vector<char> src(msg, 'x');
+    std::vector<char> dst(64 << 10);
+    SplitCheck check;
+    u64 seq;
+
+    if (state.thread_index() == 0) {
+        split = new SplitRing;
+    }
+    for (auto _ : state) {
+        if (state.thread_index() == 0) {
+            mutex_lock(&split->wlock);
+            if (dev_ring_make_room(&split->r.ring, dev_rec_size(msg), dev_cursor_done(&split->r.cur),
+                                   false) == SUCCESSFUL) {
+                memcpy(src.data(), &split->r.ring.seq, sizeof(u64));
+                dev_ring_push(&split->r.ring, src.data(), msg, 0, &seq);
+            }
+            mutex_unlock(&split->wlock);
+        } else {
+            mutex_lock(&split->lock);
+            ssize_t len = split->r.cur.pos < smp_load_acquire(&split->r.ring.head) ?
+                          dev_ring_read_records(&split->r.ring, &split->r.cur, dst.data(), dst.size(), NULL, NULL) : 0;
+            dev_cursor_publish(&split->r.cur);
+            mutex_unlock(&split->lock);
+            check_records(&check, dst.data(), len);
+        }
+    }
+    if (state.thread_index() == 1) {
+        if (check.torn) {
+            state.SkipWithError("reader saw a torn or out of order record");
+        }
+        state.SetItemsProcessed(check.taken);
+    }
+    if (state.thread_index() == 0) {
+        delete split;
+    }
+}
+
+}
+
+BENCHMARK(BM_Push)->RangeMultiplier(4)->Range(8, 64 << 10);
+BENCHMARK(BM_PushRead)->ArgsProduct({benchmark::CreateRange(8, 64 << 10, 8), {0, 1}});
+BENCHMARK(BM_DrainRecords)->ArgsProduct({{8, 64, 512}, {4 << 10, 64 << 10}});
+BENCHMARK(BM_LockedPushRead)->Arg(64)->ThreadRange(2, 8)->UseRealTime();
+BENCHMARK(BM_SplitPushRead)->Arg(8)->Arg(64)->Threads(2)->UseRealTime();
+
+BENCHMARK_MAIN();
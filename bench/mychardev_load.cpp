@@ -0,0 +1,665 @@
+//A load generator for mychardev driven by fio style job files, for mixed workloads that one
+//message size at a time cannot show. Every section of the INI file is a job with its own
+//producers and consumers, rate, size distribution, API and bursts, and jobs run side by side
+//against the same or different devices. One CSV row per job gives its throughput, the
+//latency from the producer sending a message to a consumer reading it, and what it lost.
+//
+//  ; Keys in [global] are the defaults for every job after it
+//  [global]
+//  device=/dev/mychardev
+//  runtime=10s
+//
+//  [ticks]               ; small messages at a steady rate
+//  producers=4
+//  rate=20k              ; messages per second per producer, 0 or unset for no limit
+//  size=64
+//
+//  [bulk]                ; a heavy tail of big messages that comes in bursts
+//  size_dist=pareto      ; fixed, uniform or pareto
+//  size_min=256
+//  size_max=64k
+//  pareto_alpha=1.2
+//  burst=500             ; every burst_every, each producer also sends this many at once
+//  burst_every=250ms
+//  api=readv             ; rw or readv, readv and writev move batch messages per call
+//  batch=16
+//
+//  [after]
+//  stonewall             ; waits for every job before it to finish first
+//  consumers=8
+//
+//The other keys are policy (overwrite, drop or block, set on the device for the job's run
+//and put back after) and seed, for the size distributions. Times take ns, us, ms, s or m,
+//sizes k or m, rates k or m.
+//
+//Every message starts with a struct load_msg. Consumers read in records mode, and only count
+//messages from their own job in this run, so jobs sharing a device do not count each other.
+//A message is lost to a consumer when it finds a gap in a producer's sequence. With a rate
+//set, latency is measured from when a message was due to go out rather than when it did, so
+//a producer held up by the device does not hide the delay from the numbers.
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "mychardev.h"
+#include "latency_histogram.h"
+
+#define SUCCESSFUL          0
+#define MAX_IOV             64
+#define READ_BUF_LEN        (4 << 20)
+#define LINGER_NS           200000000ull //How long consumers keep reading after the producers stop
+
+enum class SizeDist {
+    Fixed,
+    Uniform,
+    Pareto,
+};
+
+enum class Api {
+    ReadWrite,
+    Vector,
+};
+
+struct Job {
+    std::string             name;
+    std::string             dev = "/dev/mychardev";
+    unsigned int            producers = 1;
+    unsigned int            consumers = 1;
+    double                  rate = 0;             //Messages per second per producer, 0 for no limit
+    SizeDist                dist = SizeDist::Fixed;
+    size_t                  size_min = 64;        //The size itself for SizeDist::Fixed
+    size_t                  size_max = 64;
+    double                  pareto_alpha = 1.5;
+    Api                     api = Api::ReadWrite;
+    unsigned int            batch = 8;
+    unsigned int            burst = 0;
+    uint64_t                burst_every_ns = 0;
+    uint64_t                runtime_ns = 10000000000ull;
+    int                     policy = -1;          //-1 leaves the device's policy alone
+    bool                    stonewall = false;
+    uint64_t                seed = 1;
+};
+
+//What every message starts with
+struct load_msg {
+    uint64_t                send_ns;  //CLOCK_MONOTONIC time it was due to go out
+    uint64_t                seq;      //Per producer
+    uint32_t                run;      //Tells this run's messages from anything left in the device
+    uint16_t                job;
+    uint16_t                producer;
+};
+
+//Totals for one job, added to by all its threads
+struct JobState {
+    const Job*              job;
+    unsigned int            index;
+    uint64_t                start_ns;
+    uint64_t                end_ns;
+    std::atomic<uint64_t>   msgs_sent{0};
+    std::atomic<uint64_t>   bytes_sent{0};
+    std::atomic<uint64_t>   msgs_received{0};
+    std::atomic<uint64_t>   bytes_received{0};
+    std::atomic<uint64_t>   lost{0};
+    std::vector<LatencyHistogram> hists;  //One per consumer
+    std::vector<int>        consumer_fds;
+};
+
+static uint32_t run_id;
+
+//Author:      Chris Martinez
+//Description: Returns CLOCK_MONOTONIC in ns
+//Date:        16 October 2026
+//Version:     1.0
+static uint64_t now_ns() {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+//Author:      Chris Martinez
+//Description: Sleeps until the CLOCK_MONOTONIC time when
+//Date:        16 October 2026
+//Version:     1.0
+static void sleep_until(uint64_t when) {
+    struct timespec ts = { (time_t)(when / 1000000000), (long)(when % 1000000000) };
+
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {
+    }
+}
+
+//Author:      Chris Martinez
+//Description: Parses a number with an optional suffix out of the ones given, each with what
+//             it multiplies by. Returns false for anything else.
+//Date:        16 October 2026
+//Version:     1.0
+static bool parse_number(const std::string& text, const std::map<std::string, double>& suffixes, double* value) {
+    char* end;
+
+    *value = strtod(text.c_str(), &end);
+    if (end == text.c_str()) {
+        return false;
+    }
+    std::string suffix(end);
+    if (suffix.empty()) {
+        return true;
+    }
+    auto it = suffixes.find(suffix);
+    if (it == suffixes.end()) {
+        return false;
+    }
+    *value *= it->second;
+    return true;
+}
+
+//Author:      Chris Martinez
+//Description: Sets one key of a job from the job file, returns false for a bad key or value
+//Date:        16 October 2026
+//Version:     1.0
+static bool set_key(Job* job, const std::string& key, const std::string& value) {
+    static const std::map<std::string, double> sizes = { { "k", 1024 }, { "K", 1024 }, { "m", 1 << 20 },
+                                                         { "M", 1 << 20 } };
+    static const std::map<std::string, double> counts = { { "k", 1e3 }, { "K", 1e3 }, { "m", 1e6 }, { "M", 1e6 } };
+    static const std::map<std::string, double> times = { { "ns", 1 }, { "us", 1e3 }, { "ms", 1e6 }, { "s", 1e9 },
+                                                         { "m", 60e9 } };
+    double n;
+
+    if (key == "device") {
+        job->dev = value;
+    } else if (key == "stonewall") {
+        job->stonewall = value.empty() || value == "1";
+    } else if (key == "size_dist") {
+        if (value == "fixed") {
+            job->dist = SizeDist::Fixed;
+        } else if (value == "uniform") {
+            job->dist = SizeDist::Uniform;
+        } else if (value == "pareto") {
+            job->dist = SizeDist::Pareto;
+        } else {
+            return false;
+        }
+    } else if (key == "api") {
+        if (value == "rw") {
+            job->api = Api::ReadWrite;
+        } else if (value == "readv") {
+            job->api = Api::Vector;
+        } else {
+            return false;
+        }
+    } else if (key == "policy") {
+        if (value == "overwrite") {
+            job->policy = MYCHARDEV_POLICY_OVERWRITE;
+        } else if (value == "drop") {
+            job->policy = MYCHARDEV_POLICY_DROP;
+        } else if (value == "block") {
+            job->policy = MYCHARDEV_POLICY_BLOCK;
+        } else {
+            return false;
+        }
+    } else if (key == "size" || key == "size_min" || key == "size_max") {
+        if (!parse_number(value, sizes, &n) || n < sizeof(load_msg)) {
+            return false;
+        }
+        if (key != "size_max") {
+            job->size_min = n;
+        }
+        if (key != "size_min") {
+            job->size_max = n;
+        }
+    } else if (key == "runtime" || key == "burst_every") {
+        //A plain number is seconds, like fio
+        if (!parse_number(value, times, &n) || n < 0) {
+            return false;
+        }
+        if (value.find_first_not_of("0123456789.") == std::string::npos) {
+            n *= 1e9;
+        }
+        (key == "runtime" ? job->runtime_ns : job->burst_every_ns) = n;
+    } else if (key == "rate" || key == "producers" || key == "consumers" || key == "burst" ||
+               key == "batch" || key == "seed" || key == "pareto_alpha") {
+        if (!parse_number(value, counts, &n) || n < 0) {
+            return false;
+        }
+        if (key == "rate") {
+            job->rate = n;
+        } else if (key == "producers") {
+            job->producers = n;
+        } else if (key == "consumers") {
+            job->consumers = n;
+        } else if (key == "burst") {
+            job->burst = n;
+        } else if (key == "batch") {
+            job->batch = n;
+        } else if (key == "seed") {
+            job->seed = n;
+        } else {
+            job->pareto_alpha = n;
+        }
+    } else {
+        return false;
+    }
+    return true;
+}
+
+//Author:      Chris Martinez
+//Description: Returns text without the spaces around it
+//Date:        16 October 2026
+//Version:     1.0
+static std::string trim(const std::string& text) {
+    size_t first = text.find_first_not_of(" \t\r");
+    size_t last = text.find_last_not_of(" \t\r");
+
+    return first == std::string::npos ? "" : text.substr(first, last - first + 1);
+}
+
+//Author:      Chris Martinez
+//Description: Reads the jobs out of an INI job file. [global] sets the defaults for the jobs
+//             after it, every other section is a job. Exits on anything it cannot parse.
+//Date:        16 October 2026
+//Version:     1.0
+static std::vector<Job> parse_job_file(const char* path) {
+    std::ifstream file(path);
+    std::vector<Job> jobs;
+    Job global;
+    Job* current = nullptr;
+    std::string line;
+    int lineno = 0;
+
+    if (!file) {
+        fprintf(stderr, "mychardev_load: cannot open %s\n", path);
+        exit(EXIT_FAILURE);
+    }
+    while (std::getline(file, line)) {
+        lineno++;
+        line = trim(line.substr(0, line.find_first_of(";#")));
+        if (line.empty()) {
+            continue;
+        }
+        if (line.front() == '[' && line.back() == ']') {
+            std::string name = trim(line.substr(1, line.size() - 2));
+            if (name == "global") {
+                current = &global;
+            } else {
+                jobs.push_back(global);
+                jobs.back().name = name;
+                current = &jobs.back();
+            }
+            continue;
+        }
+
+        size_t eq = line.find('=');
+        std::string key = trim(line.substr(0, eq));
+        std::string value = eq == std::string::npos ? "" : trim(line.substr(eq + 1));
+        if (current == nullptr || !set_key(current, key, value)) {
+            fprintf(stderr, "mychardev_load: %s:%d: bad line '%s'\n", path, lineno, line.c_str());
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    for (const Job& job : jobs) {
+        if (job.producers == 0 || job.consumers == 0 || job.batch == 0 || job.batch > MAX_IOV ||
+            job.size_max < job.size_min || job.runtime_ns == 0 || (job.burst != 0 && job.burst_every_ns == 0)) {
+            fprintf(stderr, "mychardev_load: job %s does not make sense\n", job.name.c_str());
+            exit(EXIT_FAILURE);
+        }
+    }
+    return jobs;
+}
+
+//Author:      Chris Martinez
+//Description: Picks the size of the next message from the job's distribution. Pareto draws
+//             from size_min up with the given alpha, anything past size_max is cut to it.
+//Date:        16 October 2026
+//Version:     1.0
+static size_t next_size(const Job& job, std::mt19937_64& rng) {
+    switch (job.dist) {
+        case SizeDist::Uniform:
+            return std::uniform_int_distribution<size_t>(job.size_min, job.size_max)(rng);
+        case SizeDist::Pareto: {
+            double u = std::uniform_real_distribution<double>(0, 1)(rng);
+            double size = job.size_min / std::pow(1 - u, 1 / job.pareto_alpha);
+            return size < job.size_max ? (size_t)size : job.size_max;
+        }
+        default:
+            return job.size_min;
+    }
+}
+
+//Author:      Chris Martinez
+//Description: Writes all of count messages, the iovecs one write each, waiting for room
+//             rather than blocking so the producer can still stop at the end of the run.
+//             Returns false once the run is over or on an error.
+//Date:        16 October 2026
+//Version:     1.0
+static bool send_all(int fd, struct iovec* iov, unsigned int count, bool vector, uint64_t end_ns) {
+    unsigned int done = 0;
+
+    while (done < count) {
+        ssize_t ret = vector ? writev(fd, iov + done, count - done) : write(fd, iov[done].iov_base, iov[done].iov_len);
+
+        if (ret < 0) {
+            if (errno != EAGAIN && errno != EINTR) {
+                perror("mychardev_load: write");
+                return false;
+            }
+            if (now_ns() >= end_ns) {
+                return false;
+            }
+            struct pollfd pfd = { fd, POLLOUT, 0 };
+            poll(&pfd, 1, 10);
+            continue;
+        }
+        //Whole messages first, then what is left of one the device cut short
+        while (done < count && (size_t)ret >= iov[done].iov_len) {
+            ret -= iov[done].iov_len;
+            done++;
+        }
+        if (ret > 0) {
+            iov[done].iov_base = (char*)iov[done].iov_base + ret;
+            iov[done].iov_len -= ret;
+        }
+    }
+    return true;
+}
+
+//Author:      Chris Martinez
+//Description: One producer of a job. Sends batches of messages at the job's rate, or as
+//             fast as the device takes them, plus a burst every burst_every, until the job ends.
+//Date:        16 October 2026
+//Version:     1.0
+static void producer(JobState* state, unsigned int id) {
+    const Job& job = *state->job;
+    std::mt19937_64 rng(job.seed * 1000003 + state->index * 1009 + id);
+    unsigned int batch = job.api == Api::Vector ? job.batch : 1;
+    std::vector<char> buf(job.size_max * std::max(batch, 1u));
+    struct iovec iov[MAX_IOV];
+    uint64_t interval = job.rate > 0 ? (uint64_t)(1e9 / job.rate) : 0;
+    uint64_t next = state->start_ns;
+    uint64_t next_burst = job.burst_every_ns != 0 ? state->start_ns + job.burst_every_ns : UINT64_MAX;
+    uint64_t seq = 0, msgs = 0, bytes = 0;
+
+    int fd = open(job.dev.c_str(), O_WRONLY | O_NONBLOCK);
+    if (fd < 0) {
+        perror("mychardev_load: open for writing");
+        exit(EXIT_FAILURE);
+    }
+    sleep_until(state->start_ns);
+
+    while (now_ns() < state->end_ns) {
+        unsigned int count = batch;
+        uint64_t due;
+
+        //A burst goes out back to back in batches, on top of the steady rate
+        if (now_ns() >= next_burst) {
+            due = next_burst;
+            count = job.burst;
+            next_burst += job.burst_every_ns;
+        } else if (interval != 0) {
+            sleep_until(std::min(next, next_burst));
+            if (next > next_burst) {
+                continue;
+            }
+            due = next;
+            next += interval * batch;
+        } else {
+            due = now_ns();
+        }
+
+        while (count > 0 && now_ns() < state->end_ns) {
+            unsigned int n = std::min(count, batch);
+
+            for (unsigned int i = 0; i < n; i++) {
+                struct load_msg msg = { due, seq++, run_id, (uint16_t)state->index, (uint16_t)id };
+
+                iov[i].iov_base = &buf[i * job.size_max];
+                iov[i].iov_len = next_size(job, rng);
+                memcpy(iov[i].iov_base, &msg, sizeof(msg));
+                bytes += iov[i].iov_len;
+            }
+            if (!send_all(fd, iov, n, batch > 1, state->end_ns)) {
+                break;
+            }
+            msgs += n;
+            count -= n;
+        }
+    }
+
+    close(fd);
+    state->msgs_sent.fetch_add(msgs);
+    state->bytes_sent.fetch_add(bytes);
+}
+
+//Author:      Chris Martinez
+//Description: One consumer of a job. Reads records until a while after the job's producers
+//             stop, and counts the job's own messages, their latency and the gaps between them.
+//Date:        16 October 2026
+//Version:     1.0
+static void consumer(JobState* state, unsigned int id) {
+    const Job& job = *state->job;
+    int fd = state->consumer_fds[id];
+    LatencyHistogram& hist = state->hists[id];
+    unsigned int batch = job.api == Api::Vector ? job.batch : 1;
+    std::vector<char> buf(READ_BUF_LEN);
+    std::vector<uint64_t> next_seq(job.producers, 0);
+    struct iovec iov[MAX_IOV];
+    uint64_t msgs = 0, bytes = 0, lost = 0;
+
+    for (unsigned int i = 0; i < batch; i++) {
+        iov[i].iov_base = &buf[i * (buf.size() / batch)];
+        iov[i].iov_len = buf.size() / batch;
+    }
+
+    while (now_ns() < state->end_ns + LINGER_NS) {
+        ssize_t ret = batch > 1 ? readv(fd, iov, batch) : read(fd, buf.data(), buf.size());
+        uint64_t now = now_ns();
+
+        if (ret < 0) {
+            if (errno != EAGAIN && errno != EINTR) {
+                perror("mychardev_load: read");
+                break;
+            }
+            struct pollfd pfd = { fd, POLLIN, 0 };
+            poll(&pfd, 1, 10);
+            continue;
+        }
+
+        //Every iovec was filled by its own read, so records never cross from one to the next
+        for (unsigned int i = 0; i < batch && ret > 0; i++) {
+            const char* seg = (const char*)iov[i].iov_base;
+            size_t seg_len = std::min<size_t>(ret, iov[i].iov_len);
+
+            ret -= seg_len;
+            for (size_t off = 0; off + sizeof(struct mychardev_rec_hdr) <= seg_len; ) {
+                struct mychardev_rec_hdr hdr;
+                struct load_msg msg;
+
+                memcpy(&hdr, seg + off, sizeof(hdr));
+                off += std::min<size_t>(MYCHARDEV_REC_SIZE(hdr.len), seg_len - off);
+                if (hdr.len < sizeof(msg) || (hdr.flags & MYCHARDEV_REC_TRUNCATED)) {
+                    continue;
+                }
+                memcpy(&msg, seg + off - MYCHARDEV_REC_SIZE(hdr.len) + sizeof(hdr), sizeof(msg));
+                if (msg.run != run_id || msg.job != state->index || msg.producer >= job.producers) {
+                    continue;
+                }
+                if (msg.seq > next_seq[msg.producer]) {
+                    lost += msg.seq - next_seq[msg.producer];
+                }
+                next_seq[msg.producer] = msg.seq + 1;
+                hist.record(now > msg.send_ns ? now - msg.send_ns : 0);
+                bytes += hdr.len;
+                msgs++;
+            }
+        }
+    }
+
+    state->msgs_received.fetch_add(msgs);
+    state->bytes_received.fetch_add(bytes);
+    state->lost.fetch_add(lost);
+}
+
+//Author:      Chris Martinez
+//Description: Sets the policy a job asks for on its device, returns the old one or -1
+//Date:        16 October 2026
+//Version:     1.0
+static int set_policy(const Job& job) {
+    int old;
+
+    if (job.policy < 0) {
+        return -1;
+    }
+    int fd = open(job.dev.c_str(), O_WRONLY);
+    if (fd < 0) {
+        return -1;
+    }
+    old = ioctl(fd, IOCTL_GET_POLICY);
+    if (old < 0 || ioctl(fd, IOCTL_SET_POLICY, job.policy) != SUCCESSFUL) {
+        fprintf(stderr, "mychardev_load: cannot set the policy of %s\n", job.dev.c_str());
+        old = -1;
+    }
+    close(fd);
+    return old;
+}
+
+//Author:      Chris Martinez
+//Description: Puts a device's policy back after a job
+//Date:        16 October 2026
+//Version:     1.0
+static void restore_policy(const Job& job, int old) {
+    if (old < 0) {
+        return;
+    }
+    int fd = open(job.dev.c_str(), O_WRONLY);
+    if (fd >= 0) {
+        ioctl(fd, IOCTL_SET_POLICY, old);
+        close(fd);
+    }
+}
+
+//Author:      Chris Martinez
+//Description: Prints a job's CSV row, latencies in microseconds
+//Date:        16 October 2026
+//Version:     1.0
+static void report(JobState* state) {
+    const Job& job = *state->job;
+    LatencyHistogram hist;
+    double secs = job.runtime_ns / 1e9;
+
+    for (const LatencyHistogram& consumer_hist : state->hists) {
+        hist.add(consumer_hist);
+    }
+    printf("%s,%u,%u,%.3f,%llu,%.3f,%llu,%llu,%.0f,%.3f,%.1f,%.1f,%.1f,%.1f,%.1f\n", job.name.c_str(),
+           job.producers, job.consumers, secs, (unsigned long long)state->msgs_sent.load(),
+           state->bytes_sent.load() / 1e6, (unsigned long long)state->msgs_received.load(),
+           (unsigned long long)state->lost.load(), state->msgs_received.load() / secs,
+           state->bytes_received.load() / 1e6 / secs, hist.percentile(50) / 1e3, hist.percentile(90) / 1e3,
+           hist.percentile(99) / 1e3, hist.percentile(99.9) / 1e3, hist.max() / 1e3);
+    fflush(stdout);
+}
+
+//Author:      Chris Martinez
+//Description: Runs jobs [first, last) side by side and prints their rows once all are done
+//Date:        16 October 2026
+//Version:     1.0
+static void run_group(const std::vector<Job>& jobs, size_t first, size_t last) {
+    std::vector<std::unique_ptr<JobState>> states;
+    std::vector<std::thread> threads;
+    std::vector<int> old_policies;
+
+    //Consumers open and skip what is already queued before anything starts, so they are
+    //there for the first message. Everything starts together a little after.
+    for (size_t i = first; i < last; i++) {
+        states.emplace_back(new JobState);
+        JobState* state = states.back().get();
+
+        state->job = &jobs[i];
+        state->index = i;
+        state->hists.resize(jobs[i].consumers);
+        old_policies.push_back(set_policy(jobs[i]));
+        for (unsigned int c = 0; c < jobs[i].consumers; c++) {
+            int fd = open(jobs[i].dev.c_str(), O_RDONLY | O_NONBLOCK);
+            if (fd < 0 || ioctl(fd, IOCTL_SET_READ_MODE, MYCHARDEV_READ_RECORDS) != SUCCESSFUL) {
+                fprintf(stderr, "mychardev_load: %s: cannot read %s in records mode: %s\n", jobs[i].name.c_str(),
+                        jobs[i].dev.c_str(), strerror(errno));
+                exit(EXIT_FAILURE);
+            }
+            std::vector<char> skip(READ_BUF_LEN);
+            while (read(fd, skip.data(), skip.size()) > 0) {
+            }
+            state->consumer_fds.push_back(fd);
+        }
+    }
+
+    uint64_t start = now_ns() + 10000000;
+    for (auto& state : states) {
+        state->start_ns = start;
+        state->end_ns = start + state->job->runtime_ns;
+        for (unsigned int c = 0; c < state->job->consumers; c++) {
+            threads.emplace_back(consumer, state.get(), c);
+        }
+        for (unsigned int p = 0; p < state->job->producers; p++) {
+            threads.emplace_back(producer, state.get(), p);
+        }
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    for (size_t i = 0; i < states.size(); i++) {
+        for (int fd : states[i]->consumer_fds) {
+            close(fd);
+        }
+        report(states[i].get());
+    }
+    //In reverse, so a device two jobs set ends up with the policy from before either
+    for (size_t i = states.size(); i-- > 0; ) {
+        restore_policy(*states[i]->job, old_policies[i]);
+    }
+}
+
+//Author:      Chris Martinez
+//Description: Reads the job file and runs its jobs, a group at a time split at stonewalls
+//Date:        16 October 2026
+//Version:     1.0
+int main(int argc, char** argv) {
+    if (argc != 2 || argv[1][0] == '-') {
+        fprintf(stderr, "usage: %s JOBFILE\n", argv[0]);
+        return argc == 2 && strcmp(argv[1], "-h") == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    std::vector<Job> jobs = parse_job_file(argv[1]);
+    if (jobs.empty()) {
+        fprintf(stderr, "mychardev_load: %s has no jobs\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+    run_id = std::random_device()();
+
+    printf("job,producers,consumers,seconds,msgs_sent,mb_sent,msgs_received,lost,recv_msgs_per_s,recv_mb_per_s,"
+           "lat_p50_us,lat_p90_us,lat_p99_us,lat_p99.9_us,lat_max_us\n");
+    size_t first = 0;
+    for (size_t i = 1; i <= jobs.size(); i++) {
+        if (i == jobs.size() || jobs[i].stonewall) {
+            run_group(jobs, first, i);
+            first = i;
+        }
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,358 @@
+//Round trip latency benchmark for mychardev. Two processes, each pinned to its own CPU,
+//pass a message back and forth: ping writes it to one device, pong reads it and writes it
+//back through a second device, and ping times how long that took. Load the module with
+//nr_devs=2 for /dev/mychardev and /dev/mychardev1.
+//
+//How each side waits for the message is the thing measured: a blocking read sleeps on the
+//device's wait queue until dev_write wakes it, poll sleeps in poll first, and busy spins on
+//a non blocking read and never sleeps at all.
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sched.h>
+#include <sys/ioctl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "latency_histogram.h"
+#include "mychardev.h"
+
+#define SUCCESSFUL          0
+#define STOP_SEQ            UINT64_MAX //Tells pong the run is over
+
+enum class Wait {
+    Block, //Blocking read
+    Poll,  //poll, then read
+    Busy,  //Spin on a non blocking read
+};
+
+struct Options {
+    std::string             ping_dev = "/dev/mychardev";
+    std::string             pong_dev = "/dev/mychardev1";
+    int                     ping_cpu = 0;
+    int                     pong_cpu = 1;
+    size_t                  size = 64;
+    unsigned long           iterations = 100000;
+    unsigned long           warmup = 1000;
+    uint64_t                interval = 0; //Expected ns between sends for the correction, 0 for the median
+    std::vector<Wait>       waits = { Wait::Block, Wait::Poll, Wait::Busy };
+};
+
+//Author:      Chris Martinez
+//Description: Returns CLOCK_MONOTONIC in nanoseconds
+//Date:        16 October 2026
+//Version:     1.0
+static uint64_t now_ns() {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+//Author:      Chris Martinez
+//Description: Pins the calling process to one CPU, a negative cpu leaves it where it is
+//Date:        16 October 2026
+//Version:     1.0
+static void pin(int cpu) {
+    cpu_set_t set;
+
+    if (cpu < 0) {
+        return;
+    }
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if (sched_setaffinity(0, sizeof(set), &set) != SUCCESSFUL) {
+        perror("mychardev_pingpong: sched_setaffinity");
+        exit(EXIT_FAILURE);
+    }
+}
+
+//Author:      Chris Martinez
+//Description: Opens a device, non blocking when the reads on it are going to spin
+//Date:        16 October 2026
+//Version:     1.0
+static int open_dev(const std::string& dev, int flags, Wait wait) {
+    int fd = open(dev.c_str(), flags | (wait == Wait::Block ? 0 : O_NONBLOCK));
+
+    if (fd < 0) {
+        fprintf(stderr, "mychardev_pingpong: open %s: %s\n", dev.c_str(), strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+    return fd;
+}
+
+//Author:      Chris Martinez
+//Description: Reads exactly len bytes, waiting for them the way wait says
+//Date:        16 October 2026
+//Version:     1.0
+static void read_msg(int fd, char* buf, size_t len, Wait wait) {
+    size_t got = 0;
+
+    while (got < len) {
+        if (wait == Wait::Poll) {
+            struct pollfd pfd = { fd, POLLIN, 0 };
+            if (poll(&pfd, 1, -1) < 0 && errno != EINTR) {
+                perror("mychardev_pingpong: poll");
+                exit(EXIT_FAILURE);
+            }
+        }
+        ssize_t ret = read(fd, buf + got, len - got);
+        if (ret > 0) {
+            got += ret;
+        } else if (ret < 0 && errno != EAGAIN && errno != EINTR) {
+            perror("mychardev_pingpong: read");
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+//Author:      Chris Martinez
+//Description: Writes all len bytes
+//Date:        16 October 2026
+//Version:     1.0
+static void write_msg(int fd, const char* buf, size_t len) {
+    size_t put = 0;
+
+    while (put < len) {
+        ssize_t ret = write(fd, buf + put, len - put);
+        if (ret > 0) {
+            put += ret;
+        } else if (ret < 0 && errno != EAGAIN && errno != EINTR) {
+            perror("mychardev_pingpong: write");
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+//Author:      Chris Martinez
+//Description: The pong side. Echoes every message from the ping device back through the
+//             pong device until it gets the stop message.
+//Date:        16 October 2026
+//Version:     1.0
+static void pong(const Options& opts, Wait wait, int ready_fd) {
+    std::vector<char> buf(opts.size);
+    int in = open_dev(opts.ping_dev, O_RDONLY, wait);
+    int out = open_dev(opts.pong_dev, O_WRONLY, wait);
+    uint64_t seq;
+
+    pin(opts.pong_cpu);
+    if (write(ready_fd, "r", 1) != 1) {
+        exit(EXIT_FAILURE);
+    }
+    close(ready_fd);
+
+    do {
+        read_msg(in, buf.data(), buf.size(), wait);
+        write_msg(out, buf.data(), buf.size());
+        memcpy(&seq, buf.data(), sizeof(seq));
+    } while (seq != STOP_SEQ);
+    close(in);
+    close(out);
+}
+
+//Author:      Chris Martinez
+//Description: The ping side. Sends each message, waits for it to come back and records
+//             the round trip. Returns the histogram of the timed round trips.
+//Date:        16 October 2026
+//Version:     1.0
+static LatencyHistogram ping(const Options& opts, Wait wait, int in, int out) {
+    std::vector<char> buf(opts.size, 'p');
+    LatencyHistogram hist;
+
+    for (uint64_t seq = 0; seq < opts.warmup + opts.iterations; seq++) {
+        uint64_t start = now_ns();
+        uint64_t echoed;
+
+        memcpy(buf.data(), &seq, sizeof(seq));
+        write_msg(out, buf.data(), buf.size());
+        read_msg(in, buf.data(), buf.size(), wait);
+        memcpy(&echoed, buf.data(), sizeof(echoed));
+        if (echoed != seq) {
+            fprintf(stderr, "mychardev_pingpong: sent %llu, got %llu back\n",
+                    (unsigned long long)seq, (unsigned long long)echoed);
+            exit(EXIT_FAILURE);
+        }
+        if (seq >= opts.warmup) {
+            hist.record(now_ns() - start);
+        }
+    }
+
+    uint64_t stop = STOP_SEQ;
+    memcpy(buf.data(), &stop, sizeof(stop));
+    write_msg(out, buf.data(), buf.size());
+    read_msg(in, buf.data(), buf.size(), wait);
+    return hist;
+}
+
+//Author:      Chris Martinez
+//Description: Empties a device so a run never sees records left from the last one
+//Date:        16 October 2026
+//Version:     1.0
+static void reset_dev(const std::string& dev) {
+    int fd = open(dev.c_str(), O_WRONLY);
+
+    if (fd < 0 || ioctl(fd, IOCTL_RESET_BUF) != SUCCESSFUL) {
+        fprintf(stderr, "mychardev_pingpong: could not reset %s: %s\n", dev.c_str(), strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+    close(fd);
+}
+
+//Author:      Chris Martinez
+//Description: Runs one wait strategy: forks pong, runs ping against it and returns ping's
+//             histogram
+//Date:        16 October 2026
+//Version:     1.0
+static LatencyHistogram run_wait(const Options& opts, Wait wait) {
+    int ready[2];
+    char c;
+
+    reset_dev(opts.ping_dev);
+    reset_dev(opts.pong_dev);
+    if (pipe(ready) != SUCCESSFUL) {
+        perror("mychardev_pingpong: pipe");
+        exit(EXIT_FAILURE);
+    }
+
+    //Ping opens its reader before pong can write anything back
+    int in = open_dev(opts.pong_dev, O_RDONLY, wait);
+    int out = open_dev(opts.ping_dev, O_WRONLY, wait);
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("mychardev_pingpong: fork");
+        exit(EXIT_FAILURE);
+    }
+    if (pid == 0) {
+        close(ready[0]);
+        close(in);
+        close(out);
+        pong(opts, wait, ready[1]);
+        _exit(EXIT_SUCCESS);
+    }
+
+    close(ready[1]);
+    pin(opts.ping_cpu);
+    if (read(ready[0], &c, 1) != 1) {
+        fprintf(stderr, "mychardev_pingpong: pong did not start\n");
+        exit(EXIT_FAILURE);
+    }
+    close(ready[0]);
+
+    LatencyHistogram hist = ping(opts, wait, in, out);
+    close(in);
+    close(out);
+    waitpid(pid, nullptr, 0);
+    return hist;
+}
+
+//Author:      Chris Martinez
+//Description: Prints one CSV row of a histogram's percentiles, in nanoseconds
+//Date:        16 October 2026
+//Version:     1.0
+static void print_row(const char* wait, const char* kind, const LatencyHistogram& hist) {
+    printf("%s,%s,%llu,%.0f,%llu,%llu,%llu,%llu,%llu,%llu,%llu,%llu\n", wait, kind,
+           (unsigned long long)hist.count(), hist.mean(), (unsigned long long)hist.min(),
+           (unsigned long long)hist.percentile(50), (unsigned long long)hist.percentile(90),
+           (unsigned long long)hist.percentile(99), (unsigned long long)hist.percentile(99.9),
+           (unsigned long long)hist.percentile(99.99), (unsigned long long)hist.percentile(99.999),
+           (unsigned long long)hist.max());
+}
+
+//Author:      Chris Martinez
+//Description: Prints how to run the benchmark
+//Date:        16 October 2026
+//Version:     1.0
+static void usage(const char* prog) {
+    fprintf(stderr,
+            "usage: %s [options]\n"
+            "  -a DEV     device ping writes to (default /dev/mychardev)\n"
+            "  -b DEV     device pong writes back to (default /dev/mychardev1)\n"
+            "  -C A,B     CPUs to pin ping and pong to, -1 to not pin (default 0,1)\n"
+            "  -s BYTES   message size, at least 8 (default 64)\n"
+            "  -n N       timed round trips per strategy (default 100000)\n"
+            "  -w N       untimed round trips first (default 1000)\n"
+            "  -W LIST    wait strategies out of block, poll and busy (default all three)\n"
+            "  -i NS      interval sends were meant to go out at, for the coordinated omission\n"
+            "             correction (default the median round trip)\n",
+            prog);
+}
+
+//Author:      Chris Martinez
+//Description: Parses the options and runs each wait strategy. Prints the raw round trips
+//             and the ones corrected for coordinated omission as CSV, in nanoseconds.
+//Date:        16 October 2026
+//Version:     1.0
+int main(int argc, char** argv) {
+    static const char* wait_names[] = { "block", "poll", "busy" };
+    Options opts;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "a:b:C:s:n:w:W:i:h")) != -1) {
+        switch (opt) {
+            case 'a':
+                opts.ping_dev = optarg;
+                break;
+            case 'b':
+                opts.pong_dev = optarg;
+                break;
+            case 'C':
+                if (sscanf(optarg, "%d,%d", &opts.ping_cpu, &opts.pong_cpu) != 2) {
+                    usage(argv[0]);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 's':
+                opts.size = strtoul(optarg, nullptr, 0);
+                break;
+            case 'n':
+                opts.iterations = strtoul(optarg, nullptr, 0);
+                break;
+            case 'w':
+                opts.warmup = strtoul(optarg, nullptr, 0);
+                break;
+            case 'W':
+                opts.waits.clear();
+                for (char* name = strtok(optarg, ","); name != nullptr; name = strtok(nullptr, ",")) {
+                    unsigned int i;
+
+                    for (i = 0; i < 3 && strcmp(name, wait_names[i]) != 0; i++) {
+                    }
+                    if (i == 3) {
+                        usage(argv[0]);
+                        return EXIT_FAILURE;
+                    }
+                    opts.waits.push_back((Wait)i);
+                }
+                break;
+            case 'i':
+                opts.interval = strtoull(optarg, nullptr, 0);
+                break;
+            default:
+                usage(argv[0]);
+                return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+    if (opts.size < sizeof(uint64_t) || opts.iterations == 0) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    printf("wait,kind,count,mean,min,p50,p90,p99,p99.9,p99.99,p99.999,max\n");
+    for (Wait wait : opts.waits) {
+        LatencyHistogram hist = run_wait(opts, wait);
+        uint64_t interval = opts.interval != 0 ? opts.interval : hist.percentile(50);
+
+        print_row(wait_names[(int)wait], "raw", hist);
+        print_row(wait_names[(int)wait], "corrected", hist.corrected(interval));
+        fflush(stdout);
+    }
+    return EXIT_SUCCESS;
+}
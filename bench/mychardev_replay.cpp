@@ -0,0 +1,439 @@
+//Records the traffic going through a mychardev device to a file, and plays it back into a
+//device later with the original timing, or k times faster or slower. A burst that broke
+//something can then be run again, exactly as it came, against another build of the module.
+//
+//  mychardev_replay record [-d DEV] [-o FILE] [-t SECS] [-n N] [-S]
+//  mychardev_replay replay [-d DEV] [-i FILE] [-x SPEED] [-l LOOPS]
+//
+//Recording reads the device in records mode, so the times come from the timestamps the
+//device put on every record when it was written, not from when this program got around to
+//reading them. Load the module with timestamps on. Records already queued when recording
+//starts are skipped, so the first one kept is not played back after the device's idle time
+//before it. Recording is a reader like any other, so
+//under the overwrite or drop policy it can miss records if it falls behind, it says how
+//many at the end.
+//
+//The file is a struct replay_file_hdr and then one entry per record:
+//  varint  ns since the record before, since the header's start_ns for the first
+//  varint  bytes of data
+//  varint  records lost just before this one
+//  bytes   the data itself, unless the header has REPLAY_SIZES_ONLY
+//The varints are LEB128, so a steady stream of small records costs a few bytes each on top
+//of its data.
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+#include "mychardev.h"
+
+#define SUCCESSFUL          0
+#define REPLAY_MAGIC        "MCDREPLY"
+#define REPLAY_VERSION      1
+#define REPLAY_SIZES_ONLY   0x1     //No data was kept, replay writes zeroes of the same sizes
+#define READ_BUF_LEN        (4 << 20)
+#define SPIN_NS             50000   //Replay sleeps until this close to a write, then spins
+
+struct replay_file_hdr {
+    char        magic[8];
+    uint32_t    version;
+    uint32_t    flags;
+    uint64_t    start_ns;   //Timestamp of the first record, on the recording host's clock
+};
+
+static volatile sig_atomic_t stop;
+
+//Author:      Chris Martinez
+//Description: Asks the record loop to stop, for SIGINT and SIGTERM
+//Date:        16 October 2026
+//Version:     1.0
+static void on_signal(int) {
+    stop = 1;
+}
+
+//Author:      Chris Martinez
+//Description: Returns CLOCK_MONOTONIC in ns, the clock the device stamps records with
+//Date:        16 October 2026
+//Version:     1.0
+static uint64_t now_ns() {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+//Author:      Chris Martinez
+//Description: Writes value as a LEB128 varint
+//Date:        16 October 2026
+//Version:     1.0
+static void put_varint(FILE* file, uint64_t value) {
+    do {
+        uint8_t byte = value & 0x7f;
+
+        value >>= 7;
+        putc(value != 0 ? byte | 0x80 : byte, file);
+    } while (value != 0);
+}
+
+//Author:      Chris Martinez
+//Description: Reads a LEB128 varint into value, returns false at the end of the file
+//Date:        16 October 2026
+//Version:     1.0
+static bool get_varint(FILE* file, uint64_t* value) {
+    int shift = 0;
+    int byte;
+
+    *value = 0;
+    do {
+        byte = getc(file);
+        if (byte == EOF || shift > 63) {
+            return false;
+        }
+        *value |= (uint64_t)(byte & 0x7f) << shift;
+        shift += 7;
+    } while (byte & 0x80);
+    return true;
+}
+
+//Author:      Chris Martinez
+//Description: Records the device's traffic into path until secs have gone by, max records
+//             have been taken, or a signal comes, whichever is first. 0 means no limit.
+//             A new reader starts at the oldest record the ring still holds, so records
+//             stamped before recording started are left out, or the gap to the first new one
+//             would hold however long the device sat idle, and replay would wait it out.
+//Date:        16 October 2026
+//Version:     1.1
+static int record(const std::string& dev, const std::string& path, double secs, uint64_t max, bool sizes_only) {
+    std::vector<char> buf(READ_BUF_LEN);
+    struct replay_file_hdr file_hdr;
+    uint64_t start = now_ns();
+    uint64_t deadline = secs > 0 ? start + (uint64_t)(secs * 1e9) : 0;
+    uint64_t prev_ts = 0;
+    uint64_t next_seq = 0;
+    uint64_t count = 0, bytes = 0, lost = 0, truncated = 0, unstamped = 0, stale = 0;
+    bool first = true;
+
+    int fd = open(dev.c_str(), O_RDONLY);
+    if (fd < 0) {
+        perror("mychardev_replay: open");
+        return EXIT_FAILURE;
+    }
+    if (ioctl(fd, IOCTL_SET_READ_MODE, MYCHARDEV_READ_RECORDS) != SUCCESSFUL) {
+        perror("mychardev_replay: IOCTL_SET_READ_MODE");
+        return EXIT_FAILURE;
+    }
+    FILE* file = fopen(path.c_str(), "wb");
+    if (file == nullptr) {
+        perror("mychardev_replay: fopen");
+        return EXIT_FAILURE;
+    }
+
+    //The header is written again at the end, once the first record's time is known
+    memset(&file_hdr, 0, sizeof(file_hdr));
+    memcpy(file_hdr.magic, REPLAY_MAGIC, sizeof(file_hdr.magic));
+    file_hdr.version = REPLAY_VERSION;
+    file_hdr.flags = sizes_only ? REPLAY_SIZES_ONLY : 0;
+    fwrite(&file_hdr, sizeof(file_hdr), 1, file);
+
+    while (!stop && (max == 0 || count < max)) {
+        struct pollfd pfd = { fd, POLLIN, 0 };
+        int timeout = -1;
+
+        if (deadline != 0) {
+            uint64_t now = now_ns();
+            if (now >= deadline) {
+                break;
+            }
+            timeout = (deadline - now) / 1000000 + 1;
+        }
+        if (poll(&pfd, 1, timeout) <= 0) {
+            continue; //A timeout or a signal, the loop checks which
+        }
+        ssize_t amt = read(fd, buf.data(), buf.size());
+        if (amt < 0) {
+            if (errno == EINTR || errno == EAGAIN) {
+                continue;
+            }
+            perror("mychardev_replay: read");
+            break;
+        }
+
+        for (ssize_t off = 0; off < amt && (max == 0 || count < max); ) {
+            struct mychardev_rec_hdr hdr;
+
+            memcpy(&hdr, buf.data() + off, sizeof(hdr));
+            const char* data = buf.data() + off + sizeof(hdr);
+            off += std::min<ssize_t>(MYCHARDEV_REC_SIZE(hdr.len), amt - off);
+            //Queued before we started, it was not part of the traffic being recorded
+            if (hdr.ts_ns != 0 && hdr.ts_ns < start) {
+                stale++;
+                continue;
+            }
+            //A record recorded without a timestamp gets the time it was read instead
+            uint64_t ts = hdr.ts_ns;
+            if (ts == 0) {
+                ts = now_ns();
+                unstamped++;
+            }
+            if (first) {
+                file_hdr.start_ns = ts;
+                prev_ts = ts;
+                next_seq = hdr.seq;
+                first = false;
+            }
+            //A device reset can put the times of the records after it out of order
+            uint64_t gap = ts > prev_ts ? ts - prev_ts : 0;
+            uint64_t missed = hdr.seq > next_seq ? hdr.seq - next_seq : 0;
+
+            put_varint(file, gap);
+            put_varint(file, hdr.len);
+            put_varint(file, missed);
+            if (!sizes_only) {
+                fwrite(data, 1, hdr.len, file);
+            }
+            if (hdr.flags & MYCHARDEV_REC_TRUNCATED) {
+                truncated++;
+            }
+            prev_ts = ts;
+            next_seq = hdr.seq + 1;
+            lost += missed;
+            bytes += hdr.len;
+            count++;
+        }
+    }
+
+    rewind(file);
+    fwrite(&file_hdr, sizeof(file_hdr), 1, file);
+    fclose(file);
+    close(fd);
+
+    fprintf(stderr, "mychardev_replay: recorded %llu records, %llu bytes, %llu lost\n",
+            (unsigned long long)count, (unsigned long long)bytes, (unsigned long long)lost);
+    if (stale != 0) {
+        fprintf(stderr, "mychardev_replay: skipped %llu records queued before recording started\n",
+                (unsigned long long)stale);
+    }
+    if (truncated != 0) {
+        fprintf(stderr, "mychardev_replay: %llu records were bigger than %d bytes and were cut short\n",
+                (unsigned long long)truncated, READ_BUF_LEN);
+    }
+    if (unstamped != 0) {
+        fprintf(stderr, "mychardev_replay: %llu records had no timestamp, their times are when they were read\n",
+                (unsigned long long)unstamped);
+    }
+    return EXIT_SUCCESS;
+}
+
+//Author:      Chris Martinez
+//Description: Waits until the CLOCK_MONOTONIC time when. Sleeps most of the way, then spins
+//             for the last SPIN_NS so a write goes out close to its time.
+//Date:        16 October 2026
+//Version:     1.0
+static void wait_until(uint64_t when) {
+    uint64_t now = now_ns();
+
+    if (when > now + SPIN_NS) {
+        uint64_t wake = when - SPIN_NS;
+        struct timespec ts = { (time_t)(wake / 1000000000), (long)(wake % 1000000000) };
+
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr);
+    }
+    while (now_ns() < when) {
+    }
+}
+
+//Author:      Chris Martinez
+//Description: Writes all of data to the device. A record bigger than the ring is cut short
+//             by the device, so the rest goes in as further writes, as any writer's would.
+//Date:        16 October 2026
+//Version:     1.0
+static bool write_all(int fd, const char* data, size_t len) {
+    do {
+        ssize_t amt = write(fd, data, len);
+
+        if (amt < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += amt;
+        len -= amt;
+    } while (len > 0);
+    return true;
+}
+
+//Author:      Chris Martinez
+//Description: Plays path back into the device loops times. speed scales the gaps between
+//             records: 2 plays twice as fast, 0 writes every record as soon as it can.
+//             Reports how late the writes went out compared with when they were due.
+//Date:        16 October 2026
+//Version:     1.0
+static int replay(const std::string& dev, const std::string& path, double speed, unsigned int loops) {
+    struct replay_file_hdr file_hdr;
+    std::vector<char> data;
+    uint64_t count = 0, bytes = 0, late_total = 0, late_max = 0;
+
+    FILE* file = fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+        perror("mychardev_replay: fopen");
+        return EXIT_FAILURE;
+    }
+    if (fread(&file_hdr, sizeof(file_hdr), 1, file) != 1 ||
+        memcmp(file_hdr.magic, REPLAY_MAGIC, sizeof(file_hdr.magic)) != 0 || file_hdr.version != REPLAY_VERSION) {
+        fprintf(stderr, "mychardev_replay: %s is not a recording\n", path.c_str());
+        return EXIT_FAILURE;
+    }
+    int fd = open(dev.c_str(), O_WRONLY);
+    if (fd < 0) {
+        perror("mychardev_replay: open");
+        return EXIT_FAILURE;
+    }
+
+    for (unsigned int loop = 0; loop < loops && !stop; loop++) {
+        uint64_t start = now_ns();
+        uint64_t offset = 0; //ns into the recording
+        uint64_t gap, len, missed;
+
+        fseek(file, sizeof(file_hdr), SEEK_SET);
+        while (!stop && get_varint(file, &gap) && get_varint(file, &len) && get_varint(file, &missed)) {
+            data.resize(len);
+            if (file_hdr.flags & REPLAY_SIZES_ONLY) {
+                memset(data.data(), 0, len);
+            } else if (fread(data.data(), 1, len, file) != len) {
+                fprintf(stderr, "mychardev_replay: %s ends part way through a record\n", path.c_str());
+                break;
+            }
+
+            offset += gap;
+            uint64_t due = start + (speed > 0 ? (uint64_t)(offset / speed) : 0);
+            if (speed > 0) {
+                wait_until(due);
+            }
+            uint64_t sent = now_ns();
+            if (!write_all(fd, data.data(), len)) {
+                perror("mychardev_replay: write");
+                stop = 1;
+                break;
+            }
+
+            if (speed > 0) {
+                uint64_t late = sent > due ? sent - due : 0;
+                late_total += late;
+                late_max = std::max(late_max, late);
+            }
+            bytes += len;
+            count++;
+        }
+    }
+    fclose(file);
+    close(fd);
+
+    fprintf(stderr, "mychardev_replay: replayed %llu records, %llu bytes", (unsigned long long)count,
+            (unsigned long long)bytes);
+    if (speed > 0 && count != 0) {
+        fprintf(stderr, ", writes late by %.0f ns on average and %llu ns at most",
+                (double)late_total / count, (unsigned long long)late_max);
+    }
+    fprintf(stderr, "\n");
+    return EXIT_SUCCESS;
+}
+
+//Author:      Chris Martinez
+//Description: Prints how to run the tool
+//Date:        16 October 2026
+//Version:     1.0
+static void usage(const char* prog) {
+    fprintf(stderr,
+            "usage: %s record [options]\n"
+            "  -d DEV     device to record (default /dev/mychardev)\n"
+            "  -o FILE    where to write the recording (default mychardev.rec)\n"
+            "  -t SECS    stop after this long (default until interrupted)\n"
+            "  -n N       stop after this many records\n"
+            "  -S         keep only the sizes and times, not the data\n"
+            "usage: %s replay [options]\n"
+            "  -d DEV     device to write into (default /dev/mychardev)\n"
+            "  -i FILE    recording to play (default mychardev.rec)\n"
+            "  -x SPEED   how much faster than recorded, 0 for no waiting (default 1)\n"
+            "  -l N       play the recording this many times (default 1)\n",
+            prog, prog);
+}
+
+//Author:      Chris Martinez
+//Description: Parses the subcommand and its options and runs it
+//Date:        16 October 2026
+//Version:     1.0
+int main(int argc, char** argv) {
+    std::string dev = "/dev/mychardev";
+    std::string path = "mychardev.rec";
+    double secs = 0;
+    uint64_t max = 0;
+    bool sizes_only = false;
+    double speed = 1.0;
+    unsigned int loops = 1;
+    int opt;
+
+    if (argc < 2 || (strcmp(argv[1], "record") != 0 && strcmp(argv[1], "replay") != 0)) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    bool recording = strcmp(argv[1], "record") == 0;
+
+    optind = 2;
+    while ((opt = getopt(argc, argv, recording ? "d:o:t:n:Sh" : "d:i:x:l:h")) != -1) {
+        switch (opt) {
+            case 'd':
+                dev = optarg;
+                break;
+            case 'o':
+            case 'i':
+                path = optarg;
+                break;
+            case 't':
+                secs = strtod(optarg, nullptr);
+                break;
+            case 'n':
+                max = strtoull(optarg, nullptr, 0);
+                break;
+            case 'S':
+                sizes_only = true;
+                break;
+            case 'x':
+                speed = strtod(optarg, nullptr);
+                break;
+            case 'l':
+                loops = strtoul(optarg, nullptr, 0);
+                break;
+            default:
+                usage(argv[0]);
+                return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+    if (speed < 0 || loops == 0) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    //Without SA_RESTART, so a blocked read or sleep comes back and the loop sees stop
+    struct sigaction act;
+    memset(&act, 0, sizeof(act));
+    act.sa_handler = on_signal;
+    sigaction(SIGINT, &act, nullptr);
+    sigaction(SIGTERM, &act, nullptr);
+
+    if (recording) {
+        return record(dev, path, secs, max, sizes_only);
+    }
+    return replay(dev, path, speed, loops);
+}
@@ -0,0 +1,175 @@
+//Splits the cost of a write and a read on mychardev into the device's own code and what the
+//syscalls and user copies add on top. For every message size, IOCTL_SELF_BENCH times the
+//device's ring code inside the kernel, then the same write and read pair is timed from here
+//through the syscalls, and one CSV row gives both and the difference. Needs CAP_SYS_ADMIN.
+//
+//The userspace loop runs on a file of its own, so other readers of the device only slow it
+//down if they fall far enough behind to hold the writer up.
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+#include "mychardev.h"
+
+#define SUCCESSFUL          0
+
+struct Options {
+    std::string             dev = "/dev/mychardev";
+    std::vector<size_t>     sizes = { 8, 64, 512, 4096 };
+    uint64_t                iters = 1000000;
+    bool                    records = false;
+};
+
+//Author:      Chris Martinez
+//Description: Parses a list of sizes like 8,64,4k,1m
+//Date:        16 October 2026
+//Version:     1.0
+static std::vector<size_t> parse_sizes(const char* arg) {
+    std::vector<size_t> sizes;
+    char* end = const_cast<char*>(arg);
+
+    while (*end != '\0') {
+        size_t size = strtoull(end, &end, 0);
+
+        if (*end == 'k' || *end == 'K') {
+            size <<= 10;
+            end++;
+        } else if (*end == 'm' || *end == 'M') {
+            size <<= 20;
+            end++;
+        }
+        if (size != 0) {
+            sizes.push_back(size);
+        }
+        if (*end == ',') {
+            end++;
+        } else if (*end != '\0') {
+            return {};
+        }
+    }
+    return sizes;
+}
+
+//Author:      Chris Martinez
+//Description: Reads everything already queued for fd, so the timed loop starts level with the head
+//Date:        16 October 2026
+//Version:     1.0
+static void drain(int fd) {
+    std::vector<char> buf(1 << 20);
+
+    while (read(fd, buf.data(), buf.size()) > 0) {
+    }
+}
+
+//Author:      Chris Martinez
+//Description: Times iters write and read pairs of size bytes through the syscalls, returns ns
+//             per pair or a negative value when a write or read fails
+//Date:        16 October 2026
+//Version:     1.0
+static double syscall_ns_per_op(int fd, size_t size, uint64_t iters, bool records) {
+    std::vector<char> src(size, 0x5a);
+    std::vector<char> dst(records ? MYCHARDEV_REC_SIZE(size) : size);
+
+    drain(fd);
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < iters; i++) {
+        if (write(fd, src.data(), size) != (ssize_t)size || read(fd, dst.data(), dst.size()) <= 0) {
+            return -1;
+        }
+    }
+    std::chrono::duration<double, std::nano> ns = std::chrono::steady_clock::now() - start;
+    return ns.count() / iters;
+}
+
+//Author:      Chris Martinez
+//Description: Prints how to run the benchmark
+//Date:        16 October 2026
+//Version:     1.0
+static void usage(const char* prog) {
+    fprintf(stderr,
+            "usage: %s [options]\n"
+            "  -d DEV     device to measure (default /dev/mychardev)\n"
+            "  -s LIST    message sizes, e.g. 8,64,4k (default 8,64,512,4096)\n"
+            "  -n N       write and read pairs per size (default 1000000, at most %d)\n"
+            "  -r         read in records mode instead of as a stream\n",
+            prog, MYCHARDEV_SELF_BENCH_MAX);
+}
+
+//Author:      Chris Martinez
+//Description: Parses the options, then prints one CSV row per size with the in-kernel and the
+//             syscall cost of a write and read pair
+//Date:        16 October 2026
+//Version:     1.0
+int main(int argc, char** argv) {
+    Options opts;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "d:s:n:rh")) != -1) {
+        switch (opt) {
+            case 'd':
+                opts.dev = optarg;
+                break;
+            case 's':
+                opts.sizes = parse_sizes(optarg);
+                break;
+            case 'n':
+                opts.iters = strtoull(optarg, nullptr, 0);
+                break;
+            case 'r':
+                opts.records = true;
+                break;
+            default:
+                usage(argv[0]);
+                return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+    if (opts.sizes.empty() || opts.iters == 0 || opts.iters > MYCHARDEV_SELF_BENCH_MAX) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    int fd = open(opts.dev.c_str(), O_RDWR | O_NONBLOCK);
+    if (fd < 0) {
+        perror("mychardev_selfbench: open");
+        return EXIT_FAILURE;
+    }
+    if (ioctl(fd, IOCTL_SET_READ_MODE, opts.records ? MYCHARDEV_READ_RECORDS : MYCHARDEV_READ_STREAM) != SUCCESSFUL) {
+        perror("mychardev_selfbench: IOCTL_SET_READ_MODE");
+        return EXIT_FAILURE;
+    }
+
+    printf("msg_bytes,read_mode,iters,kernel_ns_per_op,kernel_cycles_per_op,syscall_ns_per_op,syscall_overhead_ns_per_op\n");
+    for (size_t size : opts.sizes) {
+        struct mychardev_self_bench bench;
+
+        memset(&bench, 0, sizeof(bench));
+        bench.iters = opts.iters;
+        bench.len = size;
+        if (ioctl(fd, IOCTL_SELF_BENCH, &bench) != SUCCESSFUL) {
+            fprintf(stderr, "mychardev_selfbench: IOCTL_SELF_BENCH at %zu bytes: %s\n", size, strerror(errno));
+            continue;
+        }
+        double ns = syscall_ns_per_op(fd, size, opts.iters, opts.records);
+        if (ns < 0) {
+            fprintf(stderr, "mychardev_selfbench: write and read at %zu bytes: %s\n", size, strerror(errno));
+            continue;
+        }
+
+        //The ioctl's totals give a fractional ns per op, finer than its rounded ns_per_op
+        double kernel_ns = (double)bench.ns / bench.iters;
+        printf("%zu,%s,%llu,%.1f,%.1f,%.1f,%.1f\n", size, opts.records ? "records" : "stream",
+               (unsigned long long)opts.iters, kernel_ns, (double)bench.cycles / bench.iters, ns, ns - kernel_ns);
+        fflush(stdout);
+    }
+    close(fd);
+    return EXIT_SUCCESS;
+}
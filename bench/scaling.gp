@@ -0,0 +1,40 @@
+# Plots a scaling sweep from mychardev_bench -S: throughput and CPU time per message against
+# the number of threads, one line for every transport and message size in the CSV.
+#
+#   ./mychardev_bench -S both > scaling.csv
+#   gnuplot -e "csv='scaling.csv'" scaling.gp
+#
+# csv is the sweep to plot (default scaling.csv), out the PNG to write (default scaling.png)
+# and x the count that was swept, producers or consumers (default producers).
+if (!exists("csv")) csv = "scaling.csv"
+if (!exists("out")) out = "scaling.png"
+if (!exists("x")) x = "producers"
+
+# Columns of the CSV mychardev_bench prints
+xcol = (x eq "consumers") ? 4 : 3
+msgs_per_s = 10
+cpu_ns_per_msg = 12
+
+# Every transport:msg_bytes pair in the CSV, and the rows for one of them
+series = system("awk -F, 'NR > 1 { print $1 \":\" $5 }' " . csv . " | sort -u -t: -k1,1 -k2,2n")
+rows(s) = sprintf("< awk -F, 'NR > 1 && $1 \":\" $5 == \"%s\"' %s", s, csv)
+
+set terminal pngcairo size 1400,550
+set output out
+set datafile separator ","
+set multiplot layout 1,2
+set grid
+set key top left
+set xlabel x
+set xtics 1
+
+set title "Throughput"
+set ylabel "messages/s"
+plot for [s in series] rows(s) using xcol:msgs_per_s with linespoints title s
+
+set title "Cost per message"
+set ylabel "CPU ns per message"
+set logscale y
+plot for [s in series] rows(s) using xcol:cpu_ns_per_msg with linespoints title s
+
+unset multiplot
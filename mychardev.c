@@ -7,146 +7,1445 @@
 #include <linux/mutex.h>
 #include <linux/fs.h>
 #include <linux/uaccess.h>
+#include <linux/slab.h>
+#include <linux/mempool.h>
+#include <linux/mm.h>
+#include <linux/log2.h>
+#include <linux/workqueue.h>
+#include <linux/timekeeping.h>
+#include <linux/percpu.h>
+#include <linux/debugfs.h>
+#include <linux/seq_file.h>
+#include <linux/jump_label.h>
+#include <linux/moduleparam.h>
+#include <linux/sched.h>
+#include <linux/sched/signal.h>
+#include <linux/capability.h>
+#include <linux/timex.h>
+
+#include "mychardev.h"
+#include "mychardev_core.h"
+#include "mychardev_variant.h"
+
+#define CREATE_TRACE_POINTS
+#include "mychardev_trace.h"
 
 #define CLASS_NAME          "myclass"
-#define DEV_BUF_LEN         256
+#define DEV_BUF_LEN         4096 //Default ring size, can be changed with the buf_len parameter
+#define DEV_BUF_MIN_LEN     64
 #define DEV_NAME            "mychardev"
-#define IOCTL_MAGIC         'k'
-#define SUCCESSFUL          0
+#define DEV_NAME_LEN        32
+#define DEV_MAX_DEVS        256
+#define DEV_FREE_DELAY_MS   1000 //How long a ring outlives the last close, so a reader can still open it
+#define DEV_READER_RESERVE  16   //Readers kept back for opens under memory pressure, see reader_reserve
+#define HIST_BUCKETS        64   //One per power of two of nanoseconds
+#define SCRUB_CHUNK_LEN     4096 //How much of the ring the scrubber zeroes per lock hold
+
+//A log2 histogram of nanoseconds, bucket i counts values in [2^i, 2^(i+1)).
+//Kept per CPU so recording a value never bounces a cacheline between readers.
+struct dev_hist {
+    u64     buckets[HIST_BUCKETS];
+};
+
+//Per CPU event counters for a device, added up only when someone reads them,
+//so counting never puts a shared cacheline or an atomic on the read/write path
+struct dev_stats {
+    u64     bytes_read;
+    u64     records_read;
+    u64     bytes_written;
+    u64     records_written;
+    u64     empty_reads;    //Reads that found nothing to read, whether they waited or not
+    u64     blocked_writes; //Writes that found no room under MYCHARDEV_POLICY_BLOCK
+    u64     wakeups;        //Writes that had sleeping readers or pollers to wake
+    u64     polls;
+    u64     drops;          //Records dropped under MYCHARDEV_POLICY_DROP
+    u64     overruns;       //Times a reader had unread records overwritten
+    u64     evictions;      //Readers cut off for going past the lag limit
+};
+
+//Where the time around each device's mutex goes, while lock_profiling is on
+struct dev_lock_prof {
+    struct dev_hist         wait;      //From asking for the lock to getting it
+    struct dev_hist         hold;      //From getting the lock to letting it go
+    u64                     acquired;
+    u64                     contended; //Acquisitions that found the lock already taken
+};
+
+//One of these per minor number. Each one has its own ring, lock and readers.
+//In the spsc build the writer takes wlock instead of lock, see dev_write_lock.
+//With DEV_LAZY_RING the ring's buffer only exists once the device has been opened, ring.buf
+//is NULL until then. It goes again free_delay_ms after the last close, records and all.
+struct mychardev_dev {
+    struct dev_ring         ring;
+    struct mutex            lock;
+    struct mutex            wlock;    //The writer's own lock in the spsc build, unused in the others
+    wait_queue_head_t       wq;       //Readers waiting for data
+    wait_queue_head_t       wq_space; //Writers waiting for room
+    struct list_head        readers;
+    struct list_head        evicted;    //Readers cut off by the lag limit, until they close
+    unsigned int            nr_readers; //Open files that can read, for DEV_MAX_READERS
+    unsigned int            nr_writers; //Open files that can write, for DEV_MAX_WRITERS
+    unsigned int            nr_open;    //Open files of any kind, and opens still setting up
+    unsigned int            policy;
+    u64                     dropped;  //Same as stats drops, but counted whether stats are on or not
+    u64                     max_lag;  //0 for no limit
+    unsigned int            lag_action;
+    u64                     progress; //Bumped whenever readers may have made room
+    struct work_struct      scrub_work;
+    struct delayed_work     free_work;  //Frees the ring free_delay_ms after the last close
+    struct dev_hist __percpu* lat_hist; //Time from dev_write queueing a record to dev_read taking it
+    struct dev_lock_prof __percpu* lock_prof;
+    struct dev_stats __percpu* stats;
+    u64                     locked_at; //When the holder got the lock, 0 if it was not timed
+    struct dentry*          debugfs;
+    struct cdev             cdev;
+    struct device*          device;
+    unsigned int            minor;
+};
 
-#define IOCTL_RESET_BUF     _IO(IOCTL_MAGIC, 0)
+//Every open file reads the ring from its own cursor. A cursor is only good for the
+//generation it was taken in, anything from an older generation is treated as gone.
+struct dev_reader {
+    struct list_head        node;
+    struct mychardev_dev*   dev;
+    struct dev_cursor       cur;
+    u64                     overruns;
+    u64                     last_read_ns; //When the file last took data, 0 if never
+    unsigned int            read_mode;
+    bool                    evicted;      //Cut off for going past the lag limit
+    pid_t                   pid;          //Who opened the file, for the debugfs readers table
+    char                    comm[TASK_COMM_LEN];
+};
 
-static int                  data_available = 0;
-static char                 dev_buf[DEV_BUF_LEN];
-static size_t               dev_buf_size = 0; //The buffer will initially be empty
+//What dev_reader_account needs to know about the read taking the records
+struct dev_read_ctx {
+    struct dev_reader*      reader;
+    u64                     now;    //When the read started, 0 with timestamps off
+};
+
+static unsigned int         buf_len = DEV_BUF_LEN;
+static unsigned int         nr_devs = DEV_NR_DEVS_DEFAULT;
+static unsigned int         overflow_policy = DEV_POLICY_DEFAULT;
+static unsigned long        max_lag;
+static unsigned int         lag_action = MYCHARDEV_LAG_SKIP;
+static unsigned int         reader_reserve = DEV_READER_RESERVE;
+static int                  free_delay_ms = DEV_FREE_DELAY_MS;
+static struct mychardev_dev* mydevs;
 static dev_t                dev_num;
-static struct cdev          mycdev;
 static struct class*        myclass;
-static struct device*       mydevice;
+static struct dentry*       mydebugfs;
+static struct kmem_cache*   reader_cache; //Every open file's struct dev_reader, see /proc/slabinfo
+static mempool_t*           reader_pool;  //reader_reserve of them set aside, NULL with no reserve
+
+//Everything optional on the read, write and poll paths is behind a static key, so a
+//feature that is off costs a patched out jump rather than a load and a branch.
+//Stats and timestamps are on unless turned off, lock profiling is off unless turned on.
+static DEFINE_STATIC_KEY_TRUE(stats_key);
+static DEFINE_STATIC_KEY_TRUE(timestamps_key);
+static DEFINE_STATIC_KEY_FALSE(lock_profiling_key);
+
+module_param(buf_len, uint, 0444);
+MODULE_PARM_DESC(buf_len, "Size of each device's ring buffer in bytes, rounded up to a power of two");
+module_param(nr_devs, uint, 0444);
+MODULE_PARM_DESC(nr_devs, "Number of devices to create, /dev/mychardev then /dev/mychardev1 and up, 0 for one per CPU");
+module_param(overflow_policy, uint, 0444);
+MODULE_PARM_DESC(overflow_policy, "Policy new devices start with: 0 overwrite oldest (default, not in spsc), 1 drop newest, 2 block (default in spsc)");
+module_param(max_lag, ulong, 0444);
+MODULE_PARM_DESC(max_lag, "Bytes a reader may fall behind before lag_action applies, 0 for no limit");
+module_param(lag_action, uint, 0444);
+MODULE_PARM_DESC(lag_action, "What happens to a reader past max_lag: 0 skip it ahead, 1 evict it");
+module_param(free_delay_ms, int, 0644);
+MODULE_PARM_DESC(free_delay_ms, "Milliseconds a ring and the records in it are kept after the device's last close (default 1000), 0 frees them at once, -1 keeps them until unload");
+module_param(reader_reserve, uint, 0444);
+MODULE_PARM_DESC(reader_reserve, "Open files whose state is set aside at load, so opens go on without waiting on reclaim and fail once it is used up, 0 for none");
+
+//Author:      Chris Martinez
+//Description: Turns the static key a feature parameter is tied to on or off when it is written
+//Date:        16 October 2026
+//Version:     1.1
+static int dev_key_param_set(const char* val, const struct kernel_param* kp) {
+    struct static_key* key = kp->arg;
+    bool enable;
+    int ret = kstrtobool(val, &enable);
+
+    if (ret != SUCCESSFUL) {
+        return ret;
+    }
+    if (enable) {
+        static_key_enable(key);
+    } else {
+        static_key_disable(key);
+    }
+    return SUCCESSFUL;
+}
+
+//Author:      Chris Martinez
+//Description: Shows whether the static key a feature parameter is tied to is on when it is read
+//Date:        16 October 2026
+//Version:     1.1
+static int dev_key_param_get(char* buf, const struct kernel_param* kp) {
+    return sysfs_emit(buf, "%c\n", static_key_enabled((struct static_key*)kp->arg) ? 'Y' : 'N');
+}
+
+static const struct kernel_param_ops dev_key_param_ops = {
+    .set = dev_key_param_set,
+    .get = dev_key_param_get,
+};
+module_param_cb(stats, &dev_key_param_ops, &stats_key.key, 0644);
+MODULE_PARM_DESC(stats, "Count reads, writes, drops and the rest, see sysfs stats and debugfs mychardev/metrics");
+module_param_cb(timestamps, &dev_key_param_ops, &timestamps_key.key, 0644);
+MODULE_PARM_DESC(timestamps, "Stamp records with the time they were written and measure read latency, ts_ns is 0 while off");
+module_param_cb(lock_profiling, &dev_key_param_ops, &lock_profiling_key.key, 0644);
+MODULE_PARM_DESC(lock_profiling, "Time waits for and holds of each device's mutex, see debugfs mychardev/<dev>/lock. The spsc writer's lock is not timed");
+
+//Author:      Chris Martinez
+//Description: Adds n to one of this CPU's counters for the device, while stats are on
+//Date:        16 October 2026
+//Version:     1.0
+#define dev_stat_add(dev, field, n) do {                 \
+    if (static_branch_likely(&stats_key)) {              \
+        this_cpu_add((dev)->stats->field, (n));          \
+    }                                                    \
+} while (0)
+#define dev_stat_inc(dev, field) dev_stat_add(dev, field, 1)
+
+//Author:      Chris Martinez
+//Description: Returns the time to stamp a record with, or 0 while timestamps are off
+//Date:        16 October 2026
+//Version:     1.0
+static u64 dev_timestamp(void) {
+    if (static_branch_likely(&timestamps_key)) {
+        return ktime_get_mono_fast_ns();
+    }
+    return 0;
+}
+
+//Author:      Chris Martinez
+//Description: Adds one value in nanoseconds to this CPU's copy of a histogram
+//Date:        16 October 2026
+//Version:     1.0
+static void dev_hist_add(struct dev_hist __percpu* hist, u64 ns) {
+    this_cpu_inc(hist->buckets[ilog2(ns | 1)]);
+}
+
+//Author:      Chris Martinez
+//Description: Adds up every CPU's copy of a histogram into buckets, returns the total count
+//Date:        16 October 2026
+//Version:     1.0
+static u64 dev_hist_sum(struct dev_hist __percpu* hist, u64* buckets) {
+    u64 total = 0;
+    int cpu, i;
+
+    memset(buckets, 0, sizeof(u64) * HIST_BUCKETS);
+    for_each_possible_cpu(cpu) {
+        struct dev_hist* cpu_hist = per_cpu_ptr(hist, cpu);
+        for (i = 0; i < HIST_BUCKETS; i++) {
+            buckets[i] += READ_ONCE(cpu_hist->buckets[i]);
+        }
+    }
+    for (i = 0; i < HIST_BUCKETS; i++) {
+        total += buckets[i];
+    }
+    return total;
+}
+
+//Author:      Chris Martinez
+//Description: Zeroes every CPU's copy of a histogram. Values added at the same time
+//             may or may not survive, which is fine for statistics.
+//Date:        16 October 2026
+//Version:     1.0
+static void dev_hist_reset(struct dev_hist __percpu* hist) {
+    int cpu;
+
+    for_each_possible_cpu(cpu) {
+        memset(per_cpu_ptr(hist, cpu), 0, sizeof(struct dev_hist));
+    }
+}
 
-static DECLARE_WAIT_QUEUE_HEAD(wq);
-static DEFINE_MUTEX(lock); //Defines and initalizes the mutex lock
+//Author:      Chris Martinez
+//Description: Returns the upper bound of the bucket holding the given percentile, in parts
+//             per ten thousand so p99.9 can be asked for (5000 is p50, 9990 is p99.9)
+//Date:        16 October 2026
+//Version:     1.0
+static u64 dev_hist_percentile(const u64* buckets, u64 total, unsigned int per_10k) {
+    u64 target = DIV_ROUND_UP(total * per_10k, 10000);
+    u64 seen = 0;
+    int i;
+
+    for (i = 0; i < HIST_BUCKETS; i++) {
+        seen += buckets[i];
+        if (seen >= target) {
+            break;
+        }
+    }
+    return i < HIST_BUCKETS - 1 ? (2ULL << i) - 1 : U64_MAX;
+}
+
+//Author:      Chris Martinez
+//Description: Prints a histogram for debugfs: the count, p50/p99/p99.9, then every
+//             non empty bucket. Percentiles are the upper bound of their bucket.
+//Date:        16 October 2026
+//Version:     1.0
+static void dev_hist_show(struct seq_file* s, struct dev_hist __percpu* hist) {
+    u64 buckets[HIST_BUCKETS];
+    u64 total = dev_hist_sum(hist, buckets);
+    int i;
+
+    seq_printf(s, "count %llu\n", total);
+    if (total == 0) {
+        return;
+    }
+    seq_printf(s, "p50_ns %llu\n", dev_hist_percentile(buckets, total, 5000));
+    seq_printf(s, "p99_ns %llu\n", dev_hist_percentile(buckets, total, 9900));
+    seq_printf(s, "p999_ns %llu\n", dev_hist_percentile(buckets, total, 9990));
+    for (i = 0; i < HIST_BUCKETS; i++) {
+        if (buckets[i] != 0) {
+            seq_printf(s, "bucket_ns %llu-%llu %llu\n", i ? 1ULL << i : 0, (2ULL << i) - 1, buckets[i]);
+        }
+    }
+}
+
+//Names and help text for every field of struct dev_stats, in the order they are shown
+static const struct dev_stat_desc {
+    const char*     name;
+    const char*     help;
+    size_t          offset;
+} dev_stat_descs[] = {
+    { "bytes_read",      "Bytes returned by read",                         offsetof(struct dev_stats, bytes_read) },
+    { "records_read",    "Records taken by readers",                       offsetof(struct dev_stats, records_read) },
+    { "bytes_written",   "Bytes accepted by write",                        offsetof(struct dev_stats, bytes_written) },
+    { "records_written", "Records queued by write",                        offsetof(struct dev_stats, records_written) },
+    { "empty_reads",     "Reads that found the ring empty",                offsetof(struct dev_stats, empty_reads) },
+    { "blocked_writes",  "Writes that found no room under the block policy", offsetof(struct dev_stats, blocked_writes) },
+    { "wakeups",         "Writes that woke sleeping readers",              offsetof(struct dev_stats, wakeups) },
+    { "polls",           "Calls to poll",                                  offsetof(struct dev_stats, polls) },
+    { "drops",           "Records dropped under the drop policy",          offsetof(struct dev_stats, drops) },
+    { "overruns",        "Times a reader had unread records overwritten",  offsetof(struct dev_stats, overruns) },
+    { "evictions",       "Readers cut off for going past the lag limit",   offsetof(struct dev_stats, evictions) },
+};
+
+//Author:      Chris Martinez
+//Description: Adds up every CPU's counters of a device into sum
+//Date:        16 October 2026
+//Version:     1.0
+static void dev_stats_sum(struct dev_stats __percpu* stats, struct dev_stats* sum) {
+    const size_t nr_fields = sizeof(*sum) / sizeof(u64);
+    u64* total = (u64*)sum;
+    int cpu;
+    size_t i;
+
+    memset(sum, 0, sizeof(*sum));
+    for_each_possible_cpu(cpu) {
+        const u64* cpu_stats = (const u64*)per_cpu_ptr(stats, cpu);
+        for (i = 0; i < nr_fields; i++) {
+            total[i] += READ_ONCE(cpu_stats[i]);
+        }
+    }
+}
+
+//Author:      Chris Martinez
+//Description: Returns one field of a summed struct dev_stats, by its descriptor
+//Date:        16 October 2026
+//Version:     1.0
+static u64 dev_stat_get(const struct dev_stats* stats, const struct dev_stat_desc* desc) {
+    return *(const u64*)((const char*)stats + desc->offset);
+}
+
+//Author:      Chris Martinez
+//Description: Slow half of dev_lock for when lock profiling is on. A failed trylock
+//             counts as contention, and only then is the wait timed.
+//Date:        16 October 2026
+//Version:     1.0
+static noinline int dev_lock_profiled(struct mychardev_dev* dev, bool interruptible) {
+    struct dev_lock_prof __percpu* prof = dev->lock_prof;
+    u64 start;
+
+    if (mutex_trylock(&dev->lock) == 0) {
+        this_cpu_inc(prof->contended);
+        start = ktime_get_mono_fast_ns();
+        if (!interruptible) {
+            mutex_lock(&dev->lock);
+        } else if (mutex_lock_interruptible(&dev->lock) != SUCCESSFUL) {
+            return -ERESTARTSYS;
+        }
+        dev->locked_at = ktime_get_mono_fast_ns();
+        dev_hist_add(&prof->wait, dev->locked_at - start);
+    } else {
+        dev->locked_at = ktime_get_mono_fast_ns();
+        dev_hist_add(&prof->wait, 0);
+    }
+    this_cpu_inc(prof->acquired);
+    return SUCCESSFUL;
+}
+
+//Author:      Chris Martinez
+//Description: Takes the device's mutex, timing it when lock profiling is on
+//Date:        16 October 2026
+//Version:     1.0
+static void dev_lock(struct mychardev_dev* dev) {
+    if (static_branch_unlikely(&lock_profiling_key)) {
+        dev_lock_profiled(dev, false);
+        return;
+    }
+    mutex_lock(&dev->lock);
+}
+
+//Author:      Chris Martinez
+//Description: Takes the device's mutex unless a signal comes first, timing it when lock
+//             profiling is on. Returns -ERESTARTSYS if interrupted.
+//Date:        16 October 2026
+//Version:     1.0
+static int dev_lock_interruptible(struct mychardev_dev* dev) {
+    if (static_branch_unlikely(&lock_profiling_key)) {
+        return dev_lock_profiled(dev, true);
+    }
+    return mutex_lock_interruptible(&dev->lock) != SUCCESSFUL ? -ERESTARTSYS : SUCCESSFUL;
+}
+
+//Author:      Chris Martinez
+//Description: Lets go of the device's mutex. When the lock was timed on the way in, the
+//             hold time is recorded. Profiling turned on mid hold is skipped, as there
+//             is nothing to measure from. locked_at is cleared either way, or a hold timed
+//             just before profiling was turned off would be measured from when it is next
+//             turned back on.
+//Date:        16 October 2026
+//Version:     1.1
+static void dev_unlock(struct mychardev_dev* dev) {
+    if (static_branch_unlikely(&lock_profiling_key) && dev->locked_at != 0) {
+        dev_hist_add(&dev->lock_prof->hold, ktime_get_mono_fast_ns() - dev->locked_at);
+    }
+    dev->locked_at = 0;
+    mutex_unlock(&dev->lock);
+}
+
+//Author:      Chris Martinez
+//Description: Takes the lock a write makes room and pushes its record under unless a signal
+//             comes first. That is the device's mutex, except in the spsc build, where the
+//             writer has wlock to itself and never waits on the reader. wlock is not timed by
+//             lock profiling. Returns -ERESTARTSYS if interrupted.
+//Date:        16 October 2026
+//Version:     1.0
+static int dev_write_lock_interruptible(struct mychardev_dev* dev) {
+    if (DEV_LOCKLESS_RING) {
+        return mutex_lock_interruptible(&dev->wlock) != SUCCESSFUL ? -ERESTARTSYS : SUCCESSFUL;
+    }
+    return dev_lock_interruptible(dev);
+}
+
+//Author:      Chris Martinez
+//Description: Takes the lock a write holds, see dev_write_lock_interruptible
+//Date:        16 October 2026
+//Version:     1.0
+static void dev_write_lock(struct mychardev_dev* dev) {
+    if (DEV_LOCKLESS_RING) {
+        mutex_lock(&dev->wlock);
+        return;
+    }
+    dev_lock(dev);
+}
+
+//Author:      Chris Martinez
+//Description: Lets go of the lock from dev_write_lock
+//Date:        16 October 2026
+//Version:     1.0
+static void dev_write_unlock(struct mychardev_dev* dev) {
+    if (DEV_LOCKLESS_RING) {
+        mutex_unlock(&dev->wlock);
+        return;
+    }
+    dev_unlock(dev);
+}
+
+//Author:      Chris Martinez
+//Description: Takes every lock of the device, for opens, closes, resets and settings, which
+//             change what both the writer and the reader go by. In the spsc build that is
+//             wlock then the device's mutex, in the others just the mutex.
+//Date:        16 October 2026
+//Version:     1.0
+static void dev_lock_all(struct mychardev_dev* dev) {
+    if (DEV_LOCKLESS_RING) {
+        mutex_lock(&dev->wlock);
+    }
+    dev_lock(dev);
+}
+
+//Author:      Chris Martinez
+//Description: Lets go of the locks from dev_lock_all
+//Date:        16 October 2026
+//Version:     1.0
+static void dev_unlock_all(struct mychardev_dev* dev) {
+    dev_unlock(dev);
+    if (DEV_LOCKLESS_RING) {
+        mutex_unlock(&dev->wlock);
+    }
+}
+
+//Author:      Chris Martinez
+//Description: Moves a reader onto the current generation of the ring, see dev_cursor_sync,
+//             and counts it when the writers overran it. Must be called with the lock held.
+//Date:        16 October 2026
+//Version:     1.2
+static void dev_reader_sync(struct dev_reader* reader) {
+    if (dev_cursor_sync(&reader->cur, &reader->dev->ring)) {
+        reader->overruns++;
+        dev_stat_inc(reader->dev, overruns);
+    }
+}
+
+//Author:      Chris Martinez
+//Description: Checks without the lock whether there is anything for the reader to read.
+//             Used by poll and the blocking read, so a stale answer only costs an extra wakeup.
+//Date:        16 October 2026
+//Version:     1.1
+static bool dev_data_available(struct dev_reader* reader) {
+    struct dev_ring* ring = &reader->dev->ring;
+
+    if (READ_ONCE(reader->evicted)) {
+        return true; //so it wakes up to find out
+    }
+    if (READ_ONCE(reader->cur.gen) != READ_ONCE(ring->gen)) {
+        return READ_ONCE(ring->head) != READ_ONCE(ring->tail);
+    }
+    return READ_ONCE(reader->cur.pos) < READ_ONCE(ring->head);
+}
+
+//Author:      Chris Martinez
+//Description: Returns how many bytes of records are queued ahead of the reader. Read without
+//             the lock for tracing, so it can be a little off while writers are busy.
+//Date:        16 October 2026
+//Version:     1.0
+static u64 dev_reader_depth(struct dev_reader* reader) {
+    u64 head = READ_ONCE(reader->dev->ring.head);
+    u64 cursor = READ_ONCE(reader->cur.pos);
+
+    return cursor < head ? head - cursor : 0;
+}
+
+//Author:      Chris Martinez
+//Description: Returns where a reader's next read will start, after resets and overruns.
+//             Must be called with the lock held.
+//Date:        16 October 2026
+//Version:     1.1
+static u64 dev_reader_cursor(struct dev_reader* reader) {
+    return dev_cursor_pos(&reader->cur, &reader->dev->ring);
+}
+
+//Author:      Chris Martinez
+//Description: Checks whether the reader is further behind the head than the device's lag
+//             limit. The record being written does not count, a reader that has read
+//             everything is never over. Must be called with the lock held.
+//Date:        16 October 2026
+//Version:     1.1
+static bool dev_reader_over_lag(struct dev_reader* reader) {
+    struct mychardev_dev* dev = reader->dev;
+
+    return dev->max_lag != 0 && dev->ring.head - dev_reader_cursor(reader) > dev->max_lag;
+}
+
+//Author:      Chris Martinez
+//Description: Cuts a reader off from the device. It moves to the evicted list, so it stops
+//             holding records back but still shows up in debugfs, and it is woken up so a
+//             blocked read or poll finds out. Must be called with the lock held.
+//Date:        16 October 2026
+//Version:     1.1
+static void dev_reader_evict(struct dev_reader* reader) {
+    WRITE_ONCE(reader->evicted, true);
+    list_move_tail(&reader->node, &reader->dev->evicted);
+    dev_stat_inc(reader->dev, evictions);
+    wake_up_interruptible(&reader->dev->wq);
+}
+
+//Author:      Chris Martinez
+//Description: Returns the oldest position any reader still needs, or the head when there
+//             are no readers. With skip_lagging, readers past the lag limit do not count,
+//             a write may overrun them. Must be called with the lock a write holds. In the
+//             spsc build that is not the reader's lock, so what its cursor last published is
+//             used, see dev_cursor_publish.
+//Date:        16 October 2026
+//Version:     1.4
+static u64 dev_min_cursor(struct mychardev_dev* dev, bool skip_lagging) {
+    struct dev_reader* reader;
+    u64 min_cursor = dev->ring.head;
+
+    //With only ever one reader there is no list to walk
+    if (DEV_MAX_READERS == 1) {
+        reader = list_first_entry_or_null(&dev->readers, struct dev_reader, node);
+        if (DEV_LOCKLESS_RING && reader != NULL) {
+            min_cursor = dev_cursor_done(&reader->cur);
+        } else if (reader != NULL && !(skip_lagging && dev_reader_over_lag(reader))) {
+            min_cursor = dev_reader_cursor(reader);
+        }
+        return min_cursor;
+    }
+
+    list_for_each_entry(reader, &dev->readers, node) {
+        if (!(skip_lagging && dev_reader_over_lag(reader))) {
+            min_cursor = min(min_cursor, dev_reader_cursor(reader));
+        }
+    }
+    return min_cursor;
+}
+
+//Author:      Chris Martinez
+//Description: Frees up need bytes at the head of the ring. Records every reader is done
+//             with are always discarded. Only when that is not enough does the lag limit
+//             apply: readers past it are evicted under MYCHARDEV_LAG_EVICT, or just stop
+//             holding records back under MYCHARDEV_LAG_SKIP. Past that, only
+//             MYCHARDEV_POLICY_OVERWRITE takes records from readers that are behind, the
+//             other policies get -ENOSPC. Must be called with the lock a write holds.
+//Date:        16 October 2026
+//Version:     1.3
+static int dev_make_room(struct mychardev_dev* dev, size_t need) {
+    struct dev_ring* ring = &dev->ring;
+    struct dev_reader* reader;
+    struct dev_reader* next;
+    u64 done = dev_min_cursor(dev, false);
+
+    //A lagging reader is only dealt with once the writers need its room
+    if (dev->max_lag != 0 && ring->head + need - done > ring->len) {
+        if (dev->lag_action == MYCHARDEV_LAG_EVICT) {
+            list_for_each_entry_safe(reader, next, &dev->readers, node) {
+                if (dev_reader_over_lag(reader)) {
+                    dev_reader_evict(reader);
+                }
+            }
+        }
+        done = dev_min_cursor(dev, true);
+    }
+    return dev_ring_make_room(ring, need, done, dev->policy == MYCHARDEV_POLICY_OVERWRITE);
+}
+
+//Author:      Chris Martinez
+//Description: Checks whether the ring has room for need bytes, counting the records
+//             every reader is done with as free, and those only readers past the lag limit
+//             still need, as dev_make_room would take them. Must be called with the lock a
+//             write holds.
+//Date:        16 October 2026
+//Version:     1.3
+static bool dev_has_room(struct mychardev_dev* dev, size_t need) {
+    struct dev_ring* ring = &dev->ring;
+
+    return ring->head + need - dev_min_cursor(dev, dev->max_lag != 0) <= ring->len;
+}
+
+//Author:      Chris Martinez
+//Description: Checks an overflow policy exists and the build can follow it. In the per CPU
+//             build a writer cannot tell which ring its next write goes to, so it has no ring
+//             to wait or poll on for room, and MYCHARDEV_POLICY_BLOCK is refused. The spsc
+//             writer cannot take records the reader may be copying out without its lock, so
+//             MYCHARDEV_POLICY_OVERWRITE is refused there.
+//Date:        16 October 2026
+//Version:     1.1
+static bool dev_policy_valid(unsigned long policy) {
+    return policy <= MYCHARDEV_POLICY_MAX && !(DEV_PERCPU_WRITES && policy == MYCHARDEV_POLICY_BLOCK) &&
+           !(DEV_LOCKLESS_RING && policy == MYCHARDEV_POLICY_OVERWRITE);
+}
+
+//Author:      Chris Martinez
+//Description: Checks a lag limit makes sense for a ring of ring_len bytes. Less than a
+//             record header would put every reader with anything to read over it, and more
+//             than the ring can never be reached. 0, no limit, is always fine, and the only
+//             limit in the spsc build, whose writer does not see where the reader really is.
+//Date:        16 October 2026
+//Version:     1.1
+static bool dev_lag_limit_valid(u64 limit, size_t ring_len) {
+    if (DEV_LOCKLESS_RING) {
+        return limit == 0;
+    }
+    return limit == 0 || (limit >= sizeof(struct mychardev_rec_hdr) && limit <= ring_len);
+}
+
+//Author:      Chris Martinez
+//Description: Returns the size every device's ring gets from buf_len. It is rounded up to a
+//             power of two so positions can be masked.
+//Date:        16 October 2026
+//Version:     1.0
+static size_t dev_ring_len(void) {
+    return roundup_pow_of_two(max_t(unsigned int, buf_len, DEV_BUF_MIN_LEN));
+}
+
+//Author:      Chris Martinez
+//Description: Empties the ring in O(1). The old bytes stay in the buffer, but bumping
+//             the generation makes every reader treat them as absent, see dev_ring_clear.
+//             Blocked writers are let through to check for room. In the spsc build the writer
+//             goes by the reader's published cursor, so the reader is moved onto the new
+//             generation here rather than on its next read. Must be called with dev_lock_all held.
+//Date:        16 October 2026
+//Version:     1.3
+static void dev_ring_reset(struct mychardev_dev* dev) {
+    struct dev_reader* reader;
+
+    dev_ring_clear(&dev->ring);
+    if (DEV_LOCKLESS_RING) {
+        list_for_each_entry(reader, &dev->readers, node) {
+            dev_reader_sync(reader);
+        }
+    }
+    WRITE_ONCE(dev->progress, dev->progress + 1);
+}
+
+//Author:      Chris Martinez
+//Description: Zeroes the part of [start, end) of the buffer that lies inside [lo, hi).
+//Date:        16 October 2026
+//Version:     1.1
+static void dev_zero_overlap(struct dev_ring* ring, size_t start, size_t end, size_t lo, size_t hi) {
+    lo = max(lo, start);
+    hi = min(hi, end);
+    if (lo < hi) {
+        memset(ring->buf + lo, 0, hi - lo);
+    }
+}
+
+//Author:      Chris Martinez
+//Description: Background half of IOCTL_RESET_BUF_ZERO. Zeroes every byte of the buffer
+//             that does not hold live data, one chunk per lock hold so writers are never
+//             stalled for long. Data written after the reset is left alone. A ring
+//             freed in the meantime has nothing left to scrub.
+//Date:        16 October 2026
+//Version:     1.4
+static void dev_scrub_work(struct work_struct* work) {
+    struct mychardev_dev* dev = container_of(work, struct mychardev_dev, scrub_work);
+    struct dev_ring* ring = &dev->ring;
+    size_t start;
+
+    for (start = 0; start < ring->len; start += SCRUB_CHUNK_LEN) {
+        size_t end = min(start + SCRUB_CHUNK_LEN, ring->len);
+        size_t dead_start, dead_len;
+
+        dev_lock_all(dev);
+        if (ring->buf == NULL) {
+            dev_unlock_all(dev);
+            break;
+        }
+        //The live bytes are [tail, head), so everything from head up to the next
+        //wrap of the tail is dead. It may wrap past the end of the buffer.
+        dead_start = ring->head & (ring->len - 1);
+        dead_len = ring->len - (ring->head - ring->tail);
+        dev_zero_overlap(ring, start, end, dead_start, dead_start + dead_len);
+        if (dead_start + dead_len > ring->len) {
+            dev_zero_overlap(ring, start, end, 0, dead_start + dead_len - ring->len);
+        }
+        dev_unlock_all(dev);
+        cond_resched();
+    }
+}
+
+//Author:      Chris Martinez
+//Description: Counts one more open of the device and makes sure it has a ring. Counting
+//             first keeps a free that is already on its way from taking the ring away.
+//             Allocating can sleep, so it happens outside the lock, and an open that loses
+//             the race to put its ring in frees its own. The buffer is not zeroed, readers
+//             only ever see bytes a write put in, see dev_ring_do_push. Unlike the reader, the
+//             ring has no reserve behind it: it is buf_len bytes, so holding one back per
+//             device would cost as much as never freeing rings. It is only allocated when a
+//             device with no ring is opened, so it is not on the path of a busy device, and a
+//             failure gives -ENOMEM.
+//Date:        16 October 2026
+//Version:     1.3
+static int dev_ring_hold(struct mychardev_dev* dev) {
+    char* buf;
+    bool have;
+
+    dev_lock_all(dev);
+    dev->nr_open++;
+    have = dev->ring.buf != NULL;
+    dev_unlock_all(dev);
+    if (have) {
+        return SUCCESSFUL;
+    }
+
+    buf = kvmalloc(dev->ring.len, GFP_KERNEL);
+    dev_lock_all(dev);
+    if (buf == NULL) {
+        dev->nr_open--;
+        dev_unlock_all(dev);
+        pr_warn_ratelimited("mychardev: Unable to allocate a %zu byte buffer for the device.\n", dev->ring.len);
+        return -ENOMEM;
+    }
+    if (dev->ring.buf == NULL) {
+        dev->ring.buf = buf;
+        buf = NULL;
+    }
+    dev_unlock_all(dev);
+    kvfree(buf);
+    return SUCCESSFUL;
+}
+
+//Author:      Chris Martinez
+//Description: Takes the ring away from a device that nothing has open, and returns it for
+//             the caller to free once the lock is let go. Readers never take records out of
+//             the ring, so one that was ever written to is never empty, and waiting for that
+//             would keep nearly every ring. With nothing open no cursor needs the records left
+//             in it either, they go with it, and the ring is emptied for the next one to start
+//             from. Returns NULL when the ring has to stay. Must be called with dev_lock_all held.
+//Date:        16 October 2026
+//Version:     1.1
+static char* dev_ring_detach(struct mychardev_dev* dev) {
+    char* buf = dev->ring.buf;
+
+    if (!DEV_LAZY_RING || dev->nr_open != 0) {
+        return NULL;
+    }
+    dev_ring_clear(&dev->ring);
+    dev->ring.buf = NULL;
+    return buf;
+}
+
+//Author:      Chris Martinez
+//Description: Counts one open of the device gone. After the last close the ring is freed
+//             free_delay_ms later, so a producer that opens the device for every message
+//             does not allocate on every open, and a reader that opens it soon after the
+//             writer closed still finds the records. 0 frees it straight away and -1 keeps
+//             it until unload. Must be called with dev_lock_all held, returns the ring to
+//             free like dev_ring_detach.
+//Date:        16 October 2026
+//Version:     1.2
+static char* dev_ring_unhold(struct mychardev_dev* dev) {
+    int delay = READ_ONCE(free_delay_ms);
+
+    if (--dev->nr_open != 0 || !DEV_LAZY_RING || delay < 0) {
+        return NULL;
+    }
+    if (delay > 0) {
+        mod_delayed_work(system_wq, &dev->free_work, msecs_to_jiffies(delay));
+        return NULL;
+    }
+    return dev_ring_detach(dev);
+}
+
+//Author:      Chris Martinez
+//Description: The delayed half of dev_ring_unhold. The device may have been opened again
+//             since, dev_ring_detach checks.
+//Date:        16 October 2026
+//Version:     1.2
+static void dev_free_work(struct work_struct* work) {
+    struct mychardev_dev* dev = container_of(to_delayed_work(work), struct mychardev_dev, free_work);
+    char* buf;
+
+    dev_lock_all(dev);
+    buf = dev_ring_detach(dev);
+    dev_unlock_all(dev);
+    kvfree(buf);
+}
+
+//Author:      Chris Martinez
+//Description: Allocates a zeroed reader. The write path itself never allocates, the
+//             allocation every open makes is its reader, so that is where the reserve goes.
+//             With the pool, a reader comes from the slab without reclaim, then from the
+//             reserve, and once that is used up the open fails with -ENOMEM rather than
+//             wait, for as long as it takes, for another file to close. Without a reserve
+//             the slab may go into reclaim. The reserve is only for readers: the ring the
+//             first open of an idle device allocates is not covered, see dev_ring_hold.
+//Date:        16 October 2026
+//Version:     1.2
+static struct dev_reader* dev_reader_alloc(void) {
+    struct dev_reader* reader;
+
+    if (reader_pool == NULL) {
+        return kmem_cache_zalloc(reader_cache, GFP_KERNEL);
+    }
+    reader = mempool_alloc(reader_pool, GFP_NOWAIT);
+    if (reader == NULL) {
+        return NULL;
+    }
+    memset(reader, 0, sizeof(*reader));
+    return reader;
+}
+
+//Author:      Chris Martinez
+//Description: Frees a reader from dev_reader_alloc, topping the reserve back up first
+//Date:        16 October 2026
+//Version:     1.0
+static void dev_reader_free(struct dev_reader* reader) {
+    if (reader_pool != NULL) {
+        mempool_free(reader, reader_pool);
+    } else {
+        kmem_cache_free(reader_cache, reader);
+    }
+}
 
 //Author:      Chris Martinez
 //Description: This is what will run when the device driver is open.
-//             It will just print a message to notify that it's open.
+//             It will give the file its own read cursor starting at the oldest data in
+//             the ring. The message that it's open is only printed with dynamic debug on,
+//             short lived clients open the device far too often to log every one.
+//             Builds that only allow so many readers or writers turn the rest away.
+//             Readers come from reader_cache, so opens and closes in a tight loop reuse
+//             objects warm in this CPU's slab cache, and from its reserve under pressure.
+//             The first open of an idle device allocates its ring.
 //Date:        14 April 2025
-//Version:     1.0
+//Version:     1.8
 static int dev_open(struct inode* inode, struct file* file) {
-    pr_info("mychardev: The device is now opening...\n");
-    return 0;
+    struct mychardev_dev* dev = container_of(inode->i_cdev, struct mychardev_dev, cdev);
+    struct dev_reader* reader;
+    char* buf;
+    int ret;
+
+    ret = dev_ring_hold(dev);
+    if (ret < SUCCESSFUL) {
+        return ret;
+    }
+    reader = dev_reader_alloc();
+    if (reader == NULL) {
+        dev_lock_all(dev);
+        buf = dev_ring_unhold(dev);
+        dev_unlock_all(dev);
+        kvfree(buf);
+        return -ENOMEM;
+    }
+    reader->dev = dev;
+    reader->pid = task_tgid_nr(current);
+    get_task_comm(reader->comm, current);
+    INIT_LIST_HEAD(&reader->node);
+
+    //Only files that can read hold records back, a write only producer never does
+    dev_lock_all(dev);
+    if (((file->f_mode & FMODE_READ) && dev->nr_readers >= DEV_MAX_READERS) ||
+        ((file->f_mode & FMODE_WRITE) && dev->nr_writers >= DEV_MAX_WRITERS)) {
+        buf = dev_ring_unhold(dev);
+        dev_unlock_all(dev);
+        kvfree(buf);
+        dev_reader_free(reader);
+        return -EBUSY;
+    }
+    dev->nr_readers += !!(file->f_mode & FMODE_READ);
+    dev->nr_writers += !!(file->f_mode & FMODE_WRITE);
+    dev_cursor_init(&reader->cur, &dev->ring);
+    if (file->f_mode & FMODE_READ) {
+        list_add_tail(&reader->node, &dev->readers);
+    }
+    dev_unlock_all(dev);
+
+    file->private_data = reader;
+    pr_debug("mychardev: The device is now opening...\n");
+    return stream_open(inode, file);
 }
 
 //Author:      Chris Martinez
 //Description: This is what will run when the device driver is release.
-//             It will just print a message to notify that it's release.
+//             The file's cursor no longer holds back the writers, so they get woken up to
+//             check for room. Like open, the message is only printed with dynamic debug on.
+//             The last close frees the ring free_delay_ms later, see dev_ring_unhold.
 //Date:        14 April 2025
-//Version:     1.0
+//Version:     1.8
 static int dev_release(struct inode* inode, struct file* file) {
-    pr_info("mychardev: The device is now being release...\n");
+    struct dev_reader* reader = file->private_data;
+    struct mychardev_dev* dev = reader->dev;
+    char* buf;
+
+    dev_lock_all(dev);
+    list_del_init(&reader->node);
+    dev->nr_readers -= !!(file->f_mode & FMODE_READ);
+    dev->nr_writers -= !!(file->f_mode & FMODE_WRITE);
+    WRITE_ONCE(dev->progress, dev->progress + 1);
+    buf = dev_ring_unhold(dev);
+    dev_unlock_all(dev);
+    wake_up_interruptible(&dev->wq_space);
+    kvfree(buf);
+
+    dev_reader_free(reader);
+    pr_debug("mychardev: The device is now being release...\n");
     return 0;
 }
 
+//Author:      Chris Martinez
+//Description: Accounts for a record the reader has just taken: how long it sat in the
+//             ring, and one more record read. The core calls it for every record a read
+//             takes, ctx is the struct dev_read_ctx of the read. Must be called with the lock held.
+//             The fast clock read on another CPU, or from an NMI, can be a little ahead of
+//             ours, so a record stamped after now counts as no time at all rather than wrapping.
+//Date:        16 October 2026
+//Version:     1.3
+static void dev_reader_account(void* ctx, const struct mychardev_rec_hdr* hdr) {
+    struct dev_read_ctx* read = ctx;
+    struct dev_reader* reader = read->reader;
+    u64 now = read->now;
+
+    if (now != 0 && hdr->ts_ns != 0) { //either end may have had timestamps off
+        dev_hist_add(reader->dev->lat_hist, now > hdr->ts_ns ? now - hdr->ts_ns : 0);
+    }
+    dev_stat_inc(reader->dev, records_read);
+}
+
 //Author:      Chris Martinez
 //Description: This will copy data from the device's buffer to the user's buffer.
+//             Records are read in order from the file's own cursor, as a plain stream or
+//             with their headers depending on the file's read mode. Blocks until there is
+//             data unless the file is O_NONBLOCK. In the spsc build writers do not take the
+//             lock held here, see dev_write_lock.
 //             Returns the amount of data that has been copied to the user.
 //Date:        15 April 2025
-//Version:     1.0
-static ssize_t dev_read(struct file* file, char __user* user_buf, size_t amt_to_copy, loff_t* dev_offset) {
-    size_t amt_copied = 0;
+//Version:     1.5
+static ssize_t dev_do_read(struct file* file, char __user* user_buf, size_t amt_to_copy) {
+    struct dev_reader* reader = file->private_data;
+    struct mychardev_dev* dev = reader->dev;
+    struct dev_ring* ring = &dev->ring;
+    struct dev_read_ctx ctx;
+    ssize_t ret;
 
-    //If the offset exceeds the size of the dev's buffer, then there is no more data to copy 
-    if (*dev_offset >= dev_buf_size) {
-        return amt_copied;
+    if (amt_to_copy == 0) {
+        return 0;
     }
 
     //Set up a mutex, so that there is no race condition while data is being read
-    if (mutex_lock_interruptible(&lock) != SUCCESSFUL) {
+    if (dev_lock_interruptible(dev) != SUCCESSFUL) {
         return -ERESTARTSYS;
     }
 
-    //We need to determine what data is remaining in the dev's buffer that needs to be copied to the user
-    //Then if amt_to_copy exceeds the remaining amt, we must adjust
-    size_t amt_data_remaining = dev_buf_size - *dev_offset;
-    if (amt_to_copy > amt_data_remaining) {
-        amt_to_copy = amt_data_remaining;
+    //If the reader is at the head of the ring, then wait for a writer to add more.
+    //A reader evicted for lagging too far behind gets nothing more.
+    dev_reader_sync(reader);
+    if (reader->cur.pos >= READ_ONCE(ring->head)) {
+        dev_stat_inc(dev, empty_reads);
     }
-    
-    //If all the data not copied to user, then there is an issue
-    //We need to unlock the mutex, and exit the function with an error
-    if (copy_to_user(user_buf, dev_buf, amt_to_copy) != SUCCESSFUL) {
-        mutex_unlock(&lock);
-        return -EFAULT;
+    while (reader->cur.pos >= READ_ONCE(ring->head) || reader->evicted) {
+        dev_unlock(dev);
+        if (reader->evicted) {
+            return -EPIPE;
+        }
+        if (file->f_flags & O_NONBLOCK) {
+            return -EAGAIN;
+        }
+        if (wait_event_interruptible(dev->wq, dev_data_available(reader)) != SUCCESSFUL) {
+            return -ERESTARTSYS;
+        }
+        if (dev_lock_interruptible(dev) != SUCCESSFUL) {
+            return -ERESTARTSYS;
+        }
+        dev_reader_sync(reader);
     }
 
-    //Update the buffer's offset, amt_copied and set the data_available to 0
-    *dev_offset += amt_to_copy;
-    amt_copied = amt_to_copy;
-    data_available = 0;
+    //Copy out as much as fits the user's buffer, in the format the file asked for.
+    //Every record taken is measured against the same clock read.
+    ctx.reader = reader;
+    ctx.now = dev_timestamp();
+    if (reader->read_mode == MYCHARDEV_READ_RECORDS) {
+        ret = dev_ring_read_records(ring, &reader->cur, user_buf, amt_to_copy, dev_reader_account, &ctx);
+    } else {
+        ret = dev_ring_read_stream(ring, &reader->cur, user_buf, amt_to_copy, dev_reader_account, &ctx);
+    }
+    if (ret > 0) {
+        if (ctx.now != 0) {
+            reader->last_read_ns = ctx.now;
+        }
+        dev_stat_add(dev, bytes_read, ret);
+    }
+    //The spsc writer does not take our lock, so it is told what we are done with and then
+    //that there is news, with release stores it takes in the same order, see dev_do_write
+    if (DEV_LOCKLESS_RING) {
+        dev_cursor_publish(&reader->cur);
+    }
+    smp_store_release(&dev->progress, dev->progress + 1);
 
     //Unlock the mutex, and return the amount copied to user as we are done copying to the user's buffer
-    mutex_unlock(&lock);
-    return amt_copied;    
+    dev_unlock(dev);
+    if (READ_ONCE(dev->policy) == MYCHARDEV_POLICY_BLOCK) {
+        wake_up_interruptible(&dev->wq_space); //a blocked writer may fit now
+    }
+    return ret;
+}
+
+//Author:      Chris Martinez
+//Description: Returns the device a write through dev goes to. In the per CPU build that is
+//             the device of the CPU the writer is running on.
+//Date:        16 October 2026
+//Version:     1.0
+static struct mychardev_dev* dev_write_target(struct mychardev_dev* dev) {
+    if (DEV_PERCPU_WRITES) {
+        return &mydevs[raw_smp_processor_id() % nr_devs];
+    }
+    return dev;
+}
+
+//Author:      Chris Martinez
+//Description: Walks every device a write through dev can go to, which is dev itself except
+//             in the per CPU build, where it is all of them. Settings that writers act on,
+//             like the overflow policy and the lag limit, are made on each of them.
+//Date:        16 October 2026
+//Version:     1.0
+#define dev_for_each_write_target(dev, target)                                          \
+    for ((target) = DEV_PERCPU_WRITES ? mydevs : (dev);                                 \
+         (target) < (DEV_PERCPU_WRITES ? mydevs + nr_devs : (dev) + 1); (target)++)
+
+//Author:      Chris Martinez
+//Description: Writers waiting for room only wake one at a time, so a writer that was woken
+//             and is done with the wakeup, whether or not it got its room, hands it on to
+//             the next in case there is room for that one. Other builds wake every writer.
+//Date:        16 October 2026
+//Version:     1.0
+static void dev_space_wake_next(struct mychardev_dev* dev) {
+    if (DEV_EXCLUSIVE_SPACE_WAIT && wq_has_sleeper(&dev->wq_space)) {
+        wake_up_interruptible(&dev->wq_space);
+    }
 }
 
 //Author:      Chris Martinez
 //Description: This will write data to the device's buffer from the user's buffer.
+//             Each write becomes one record. A write bigger than the ring is cut short,
+//             and the caller writes the rest again. When there is no room the device's
+//             overflow policy decides whether old records go, the new one goes, or we wait.
 //             Returns the amount of data that has been written to the user.
+//             dev is the device the record goes to, see dev_write_target.
+//             seq is set to the sequence number the record was given.
+//             In the spsc build only the writer's own lock is held, see dev_write_lock.
 //Date:        15 April 2025
-//Version:     1.0
-static ssize_t dev_write(struct file* file, const char __user* user_buf, size_t amt_to_write, loff_t* dev_offset) {
-    //The amt_to_write should not exceed the total dev_buffer_len, if so exit with error
-    if (amt_to_write > dev_buf_size) {
-        return -EINVAL;
+//Version:     2.0
+static ssize_t dev_do_write(struct file* file, struct mychardev_dev* dev, const char __user* user_buf,
+                            size_t amt_to_write, u64* seq) {
+    struct dev_ring* ring = &dev->ring;
+    bool blocked = false;
+    size_t need;
+    int ret;
+
+    if (amt_to_write == 0) {
+        return 0;
     }
 
+    //A record can take up at most the whole ring, anything past that is left for the next write
+    if (amt_to_write > ring->len - sizeof(struct mychardev_rec_hdr)) {
+        amt_to_write = ring->len - sizeof(struct mychardev_rec_hdr);
+    }
+    need = dev_rec_size(amt_to_write);
+
     //Set the mutex, so no race condition happens while a write operation is happening
-    if (mutex_lock_interruptible(&lock) != SUCCESSFUL) {
+    if (dev_write_lock_interruptible(dev) != SUCCESSFUL) {
         return -ERESTARTSYS;
     }
 
-    //Write the data from the user to dev, if not successful unlock mutex and return error code
-    if (copy_from_user(dev_buf, user_buf, amt_to_write) != SUCCESSFUL) {
-        mutex_unlock(&lock);
+    //Make room for the record, or deal with there not being any
+    for (;;) {
+        //Read before looking for room, so a reader that makes room after we look has changed it
+        //by the time we wait. In the spsc build the reader bumps it without our lock.
+        u64 progress = smp_load_acquire(&dev->progress);
+
+        if (dev_make_room(dev, need) == SUCCESSFUL) {
+            break;
+        }
+        if (dev->policy == MYCHARDEV_POLICY_DROP) {
+            //The record still uses up a sequence number, so readers see the gap
+            *seq = ring->seq++;
+            WRITE_ONCE(dev->dropped, dev->dropped + 1);
+            dev_write_unlock(dev);
+            dev_stat_inc(dev, drops);
+            //Hand the wakeup on as a write that got through would, this one may have been
+            //the writer woken for the switch away from MYCHARDEV_POLICY_BLOCK
+            if (blocked) {
+                dev_space_wake_next(dev);
+            }
+            return amt_to_write;
+        }
+
+        //Woken but beaten to the room, the room that woke us may still fit the next writer
+        dev_write_unlock(dev);
+        if (blocked) {
+            dev_space_wake_next(dev);
+        } else {
+            dev_stat_inc(dev, blocked_writes);
+            blocked = true;
+        }
+        if (file->f_flags & O_NONBLOCK) {
+            return -EAGAIN;
+        }
+        if (DEV_EXCLUSIVE_SPACE_WAIT) {
+            ret = wait_event_interruptible_exclusive(dev->wq_space, READ_ONCE(dev->progress) != progress ||
+                                                     READ_ONCE(dev->policy) != MYCHARDEV_POLICY_BLOCK);
+        } else {
+            ret = wait_event_interruptible(dev->wq_space, READ_ONCE(dev->progress) != progress ||
+                                           READ_ONCE(dev->policy) != MYCHARDEV_POLICY_BLOCK);
+        }
+        if (ret != SUCCESSFUL) {
+            dev_space_wake_next(dev);
+            return -ERESTARTSYS;
+        }
+        if (dev_write_lock_interruptible(dev) != SUCCESSFUL) {
+            dev_space_wake_next(dev); //this wakeup is going unused
+            return -ERESTARTSYS;
+        }
+    }
+
+    //Write the record from the user to dev, if not successful unlock mutex and return error code.
+    //The record is stamped here under the lock, so timestamps never go back as seq goes up.
+    if (dev_ring_push(ring, user_buf, amt_to_write, dev_timestamp(), seq) != SUCCESSFUL) {
+        dev_write_unlock(dev);
         return -EFAULT;
     }
 
-    //Update the dev_buf_size, since there is new data. Must also set data_available to 1 for the poll function
-    dev_buf_size = amt_to_write;
-    data_available = 1;
+    dev_write_unlock(dev); //unlock the mutex
+    dev_stat_inc(dev, records_written);
+    dev_stat_add(dev, bytes_written, amt_to_write);
 
-    mutex_unlock(&lock); //unlock the mutex
-    wake_up_interruptible(&wq); //wake up the wait queue now that there is data available
+    //Wake up the wait queue now that there is data available. Nobody sleeping is the common
+    //case for busy readers, and checking first saves taking the wait queue's lock for nothing.
+    if (wq_has_sleeper(&dev->wq)) {
+        if (trace_mychardev_wakeup_enabled()) {
+            trace_mychardev_wakeup(dev->minor, *seq, READ_ONCE(ring->head) - READ_ONCE(ring->tail));
+        }
+        dev_stat_inc(dev, wakeups);
+        wake_up_interruptible(&dev->wq);
+    }
+
+    //A writer that got through after waiting hands the wakeup on in case there is room for the next
+    if (blocked) {
+        dev_space_wake_next(dev);
+    }
     return amt_to_write;
 }
 
 //Author:      Chris Martinez
-//Description: This will handle any poll event for the device driver
-//Date:        16 April 2025
+//Description: The read entry point. Does the read, then fires the mychardev_read
+//             tracepoint with how far behind the head the file still is.
+//Date:        16 October 2026
 //Version:     1.0
+static ssize_t dev_read(struct file* file, char __user* user_buf, size_t amt_to_copy, loff_t* dev_offset) {
+    struct dev_reader* reader = file->private_data;
+    ssize_t ret = dev_do_read(file, user_buf, amt_to_copy);
+
+    if (trace_mychardev_read_enabled()) {
+        trace_mychardev_read(reader->dev->minor, amt_to_copy, ret, dev_reader_depth(reader),
+                             READ_ONCE(reader->cur.next_seq));
+    }
+    return ret;
+}
+
+//Author:      Chris Martinez
+//Description: The write entry point. Does the write, then fires the mychardev_write
+//             tracepoint with how full the ring is. That is the ring the record went to,
+//             which in the per CPU build is the one of the CPU the write started on.
+//Date:        16 October 2026
+//Version:     1.1
+static ssize_t dev_write(struct file* file, const char __user* user_buf, size_t amt_to_write, loff_t* dev_offset) {
+    struct dev_reader* reader = file->private_data;
+    struct mychardev_dev* dev = dev_write_target(reader->dev);
+    struct dev_ring* ring = &dev->ring;
+    u64 seq = 0;
+    ssize_t ret = dev_do_write(file, dev, user_buf, amt_to_write, &seq);
+
+    if (trace_mychardev_write_enabled()) {
+        trace_mychardev_write(dev->minor, amt_to_write, ret,
+                              READ_ONCE(ring->head) - READ_ONCE(ring->tail), seq);
+    }
+    return ret;
+}
+
+//Author:      Chris Martinez
+//Description: This will handle any poll event for the device driver. Files open for
+//             writing also hear about room in the ring under MYCHARDEV_POLICY_BLOCK.
+//             The per CPU build never blocks writers, see dev_policy_valid, so the ring the
+//             next write lands in, whichever CPU that is, always takes it.
+//Date:        16 April 2025
+//Version:     1.3
 static unsigned int dev_poll(struct file* file, struct poll_table_struct* wait) {
+    struct dev_reader* reader = file->private_data;
+    struct mychardev_dev* dev = reader->dev;
     unsigned int mask = 0; //this will keep track of the boolean poll values
-    poll_wait(file, &wq, wait); //adds the wq to the queue
-    if (data_available) {
+
+    dev_stat_inc(dev, polls);
+    poll_wait(file, &dev->wq, wait); //adds the wq to the queue
+    if (READ_ONCE(reader->evicted)) {
+        mask = mask | POLLERR;
+    } else if (dev_data_available(reader)) {
         mask = mask | POLLIN | POLLRDNORM;
     }
 
+    if (file->f_mode & FMODE_WRITE) {
+        poll_wait(file, &dev->wq_space, wait);
+        if (READ_ONCE(dev->policy) != MYCHARDEV_POLICY_BLOCK) {
+            mask = mask | POLLOUT | POLLWRNORM;
+        } else {
+            //Writable once at least a quarter of the ring is free, like a pipe with PIPE_BUF
+            dev_write_lock(dev);
+            if (dev_has_room(dev, dev->ring.len / 4)) {
+                mask = mask | POLLOUT | POLLWRNORM;
+            }
+            dev_write_unlock(dev);
+        }
+    }
+
+    if (trace_mychardev_poll_enabled()) {
+        trace_mychardev_poll(dev->minor, mask, dev_reader_depth(reader));
+    }
     return mask;
 }
 
 //Author:      Chris Martinez
-//Description: This will reset the buffers
+//Description: Runs IOCTL_SELF_BENCH for a file. The records go through a scratch ring as long
+//             as the device's, so nobody reading the device sees them, but under the same
+//             locks dev_do_write and dev_do_read take and through the same core code in the
+//             file's read mode. Only the user copies are memcpys instead, and nothing is
+//             counted in the device's stats. The reader always keeps up, so the overflow
+//             policy never has to act. Other traffic on the device shows up as lock waits.
+//Date:        16 October 2026
+//Version:     1.1
+static int dev_self_bench(struct dev_reader* reader, struct mychardev_self_bench* bench) {
+    struct mychardev_dev* dev = reader->dev;
+    struct mychardev_dev* wdev = dev_write_target(dev);
+    struct dev_ring ring = { .len = dev->ring.len };
+    struct dev_cursor cur;
+    size_t need = dev_rec_size(bench->len);
+    char* src = NULL;
+    char* dst = NULL;
+    u64 start_ns, start_cycles, i, seq;
+    int ret = SUCCESSFUL;
+
+    if (bench->iters == 0 || bench->iters > MYCHARDEV_SELF_BENCH_MAX ||
+        bench->len == 0 || need > ring.len) {
+        return -EINVAL;
+    }
+    ring.buf = kvmalloc(ring.len, GFP_KERNEL);
+    src = kvmalloc(bench->len, GFP_KERNEL);
+    dst = kvmalloc(need, GFP_KERNEL);
+    if (ring.buf == NULL || src == NULL || dst == NULL) {
+        ret = -ENOMEM;
+        goto out;
+    }
+    memset(src, 0x5a, bench->len);
+    dev_cursor_init(&cur, &ring);
+
+    start_ns = ktime_get_ns();
+    start_cycles = get_cycles();
+    for (i = 0; i < bench->iters; i++) {
+        dev_write_lock(wdev);
+        dev_ring_make_room(&ring, need, dev_cursor_pos(&cur, &ring),
+                           READ_ONCE(wdev->policy) == MYCHARDEV_POLICY_OVERWRITE);
+        dev_ring_do_push(&ring, (__force const char __user*)src, bench->len, dev_timestamp(), &seq, true);
+        dev_write_unlock(wdev);
+
+        dev_lock(dev);
+        dev_cursor_sync(&cur, &ring);
+        if (reader->read_mode == MYCHARDEV_READ_RECORDS) {
+            dev_ring_do_read_records(&ring, &cur, (__force char __user*)dst, need, NULL, NULL, true);
+        } else {
+            dev_ring_do_read_stream(&ring, &cur, (__force char __user*)dst, bench->len, NULL, NULL, true);
+        }
+        dev_unlock(dev);
+
+        //Long runs must not hog the CPU or outlive a kill
+        if ((i & 1023) == 1023) {
+            if (fatal_signal_pending(current)) {
+                ret = -EINTR;
+                goto out;
+            }
+            cond_resched();
+        }
+    }
+    bench->cycles = get_cycles() - start_cycles;
+    bench->ns = ktime_get_ns() - start_ns;
+    bench->ns_per_op = div64_u64(bench->ns, bench->iters);
+    bench->cycles_per_op = div64_u64(bench->cycles, bench->iters);
+out:
+    kvfree(dst);
+    kvfree(src);
+    kvfree(ring.buf);
+    return ret;
+}
+
+//Author:      Chris Martinez
+//Description: This will reset the buffers and the latency histogram, change the device's
+//             overflow policy and lag limit and the file's read mode, and report what a
+//             reader has missed, and time the device's data path with IOCTL_SELF_BENCH.
+//             Resetting only empties the ring, the old bytes are zeroed in the background
+//             when IOCTL_RESET_BUF_ZERO asks for it. The policy and lag limit are set on
+//             every device a write through this one can go to, see dev_for_each_write_target.
 //Date:        16 April 2025
-//Version:     1.0
-static long dev_ioctl(struct file* file, unsigned int cmd, unsigned long args) {
+//Version:     2.1
+static long dev_do_ioctl(struct file* file, unsigned int cmd, unsigned long args) {
+    struct dev_reader* reader = file->private_data;
+    struct mychardev_dev* dev = reader->dev;
+    struct mychardev_dev* target;
+    struct mychardev_reader_info info;
+    struct mychardev_lag_limit limit;
+    struct mychardev_self_bench bench;
+    int ret;
+
     switch (cmd) {
         case IOCTL_RESET_BUF:
-            mutex_lock(&lock);
-            memset(dev_buf, 0, DEV_BUF_LEN); //reset the dev_buf to zero
-            dev_buf_size = 0; //if dev_buf is zeroize then reset the buf_size to zero
-            data_available = 0; //No data in buf, so no data_available
-            mutex_unlock(&lock);
-            pr_info("mychardev: The device's buffer has been resetted to zero via ioctl.\n");
+            dev_lock_all(dev);
+            dev_ring_reset(dev); //O(1), no matter how big the ring is
+            dev_unlock_all(dev);
+            wake_up_interruptible_all(&dev->wq_space);
+            pr_info("mychardev: The device's buffer has been resetted via ioctl.\n");
+            break;
+        case IOCTL_RESET_BUF_ZERO:
+            dev_lock_all(dev);
+            dev_ring_reset(dev);
+            dev_unlock_all(dev);
+            wake_up_interruptible_all(&dev->wq_space);
+            schedule_work(&dev->scrub_work); //the old bytes get zeroed off the ioctl path
+            pr_info("mychardev: The device's buffer has been resetted via ioctl, zeroing in the background.\n");
+            break;
+        case IOCTL_SET_POLICY:
+            if (!dev_policy_valid(args)) {
+                return -EINVAL;
+            }
+            dev_for_each_write_target(dev, target) {
+                dev_lock_all(target);
+                WRITE_ONCE(target->policy, args);
+                dev_unlock_all(target);
+                //Every blocked writer, not just one, as one dropping its record under the new
+                //policy would not be around to hand the wakeup on
+                wake_up_interruptible_all(&target->wq_space);
+            }
+            break;
+        case IOCTL_GET_POLICY:
+            return READ_ONCE(dev->policy);
+        case IOCTL_SET_READ_MODE:
+            if (args != MYCHARDEV_READ_STREAM && args != MYCHARDEV_READ_RECORDS) {
+                return -EINVAL;
+            }
+            dev_lock(dev);
+            reader->read_mode = args;
+            reader->cur.rec_off = 0; //a record half read as a stream is sent again in full
+            dev_unlock(dev);
+            break;
+        case IOCTL_SET_LAG_LIMIT:
+            if (copy_from_user(&limit, (void __user*)args, sizeof(limit)) != SUCCESSFUL) {
+                return -EFAULT;
+            }
+            if (limit.action > MYCHARDEV_LAG_MAX || !dev_lag_limit_valid(limit.max_lag, dev->ring.len)) {
+                return -EINVAL;
+            }
+            dev_for_each_write_target(dev, target) {
+                dev_lock_all(target);
+                target->max_lag = limit.max_lag;
+                target->lag_action = limit.action;
+                WRITE_ONCE(target->progress, target->progress + 1);
+                dev_unlock_all(target);
+                wake_up_interruptible_all(&target->wq_space); //a lagging reader may no longer hold them up
+            }
+            break;
+        case IOCTL_RESET_LATENCY:
+            //The histogram is there for alerting, not every reader gets to wipe it
+            if (!capable(CAP_SYS_ADMIN)) {
+                return -EPERM;
+            }
+            dev_hist_reset(dev->lat_hist);
+            break;
+        case IOCTL_GET_READER_INFO:
+            dev_lock(dev);
+            dev_reader_sync(reader);
+            info.next_seq = reader->cur.next_seq;
+            info.lost = reader->cur.lost;
+            info.overruns = reader->overruns;
+            info.dropped = READ_ONCE(dev->dropped); //counted under the spsc writer's own lock
+            dev_unlock(dev);
+            if (copy_to_user((void __user*)args, &info, sizeof(info)) != SUCCESSFUL) {
+                return -EFAULT;
+            }
+            break;
+        case IOCTL_SELF_BENCH:
+            if (!capable(CAP_SYS_ADMIN)) {
+                return -EPERM;
+            }
+            if (copy_from_user(&bench, (void __user*)args, sizeof(bench)) != SUCCESSFUL) {
+                return -EFAULT;
+            }
+            ret = dev_self_bench(reader, &bench);
+            if (ret != SUCCESSFUL) {
+                return ret;
+            }
+            if (copy_to_user((void __user*)args, &bench, sizeof(bench)) != SUCCESSFUL) {
+                return -EFAULT;
+            }
             break;
         default:
             return -EINVAL;
@@ -154,6 +1453,186 @@ static long dev_ioctl(struct file* file, unsigned int cmd, unsigned long args) {
     return SUCCESSFUL;
 }
 
+//Author:      Chris Martinez
+//Description: The ioctl entry point. Runs the command, then fires the mychardev_ioctl tracepoint.
+//Date:        16 October 2026
+//Version:     1.0
+static long dev_ioctl(struct file* file, unsigned int cmd, unsigned long args) {
+    struct dev_reader* reader = file->private_data;
+    long ret = dev_do_ioctl(file, cmd, args);
+
+    trace_mychardev_ioctl(reader->dev->minor, cmd, args, ret);
+    return ret;
+}
+
+//Author:      Chris Martinez
+//Description: Shows the device's write to read latency histogram in debugfs
+//Date:        16 October 2026
+//Version:     1.0
+static int dev_latency_show(struct seq_file* s, void* unused) {
+    struct mychardev_dev* dev = s->private;
+
+    dev_hist_show(s, dev->lat_hist);
+    return 0;
+}
+DEFINE_SHOW_ATTRIBUTE(dev_latency);
+
+//Author:      Chris Martinez
+//Description: Shows the device's lock profile in debugfs: how often the lock was taken
+//             and found contended, then the wait and hold time histograms
+//Date:        16 October 2026
+//Version:     1.0
+static int dev_lock_show(struct seq_file* s, void* unused) {
+    struct mychardev_dev* dev = s->private;
+    u64 acquired = 0, contended = 0;
+    int cpu;
+
+    for_each_possible_cpu(cpu) {
+        struct dev_lock_prof* prof = per_cpu_ptr(dev->lock_prof, cpu);
+        acquired += READ_ONCE(prof->acquired);
+        contended += READ_ONCE(prof->contended);
+    }
+    seq_printf(s, "enabled %d\n", static_key_enabled(&lock_profiling_key) ? 1 : 0);
+    seq_printf(s, "acquired %llu\n", acquired);
+    seq_printf(s, "contended %llu\n", contended);
+    seq_puts(s, "wait:\n");
+    dev_hist_show(s, &dev->lock_prof->wait);
+    seq_puts(s, "hold:\n");
+    dev_hist_show(s, &dev->lock_prof->hold);
+    return 0;
+}
+DEFINE_SHOW_ATTRIBUTE(dev_lock);
+
+//Author:      Chris Martinez
+//Description: Prints one reader's line of the debugfs readers table. Must be called with
+//             dev_lock_all held, as it looks at the writer's side of the ring too.
+//Date:        16 October 2026
+//Version:     1.1
+static void dev_reader_show(struct seq_file* s, struct dev_reader* reader, u64 now) {
+    struct dev_ring* ring = &reader->dev->ring;
+    //Same view of the cursor the reader will get on its next read
+    u64 cursor = dev_reader_cursor(reader);
+
+    seq_printf(s, "%d %s %llu %llu %llu ", reader->pid, reader->comm, cursor,
+               ring->head - cursor, ring->seq - dev_ring_seq_at(ring, cursor));
+    if (reader->last_read_ns != 0) {
+        seq_printf(s, "%llu", div_u64(now - reader->last_read_ns, NSEC_PER_MSEC));
+    } else {
+        seq_puts(s, "-");
+    }
+    seq_printf(s, " %llu %llu %d\n", reader->cur.lost, reader->overruns, reader->evicted ? 1 : 0);
+}
+
+//Author:      Chris Martinez
+//Description: Shows one line per file open for reading on the device in debugfs: who has it
+//             open, where its cursor is, how far behind the head it is in bytes and records,
+//             how long since it last read, what it has lost, and whether the lag limit cut
+//             it off. This is where to look for the slow consumer holding the ring back.
+//             Evicted readers come last, and stay until their file is closed.
+//Date:        16 October 2026
+//Version:     1.2
+static int dev_readers_show(struct seq_file* s, void* unused) {
+    struct mychardev_dev* dev = s->private;
+    struct dev_reader* reader;
+    u64 now = ktime_get_mono_fast_ns();
+
+    seq_puts(s, "pid comm cursor lag_bytes lag_records idle_ms lost overruns evicted\n");
+    dev_lock_all(dev);
+    list_for_each_entry(reader, &dev->readers, node) {
+        dev_reader_show(s, reader, now);
+    }
+    list_for_each_entry(reader, &dev->evicted, node) {
+        dev_reader_show(s, reader, now);
+    }
+    dev_unlock_all(dev);
+    return 0;
+}
+DEFINE_SHOW_ATTRIBUTE(dev_readers);
+
+//Author:      Chris Martinez
+//Description: Shows every device's counters in debugfs as one Prometheus text file,
+//             each device told apart by its device label
+//Date:        16 October 2026
+//Version:     1.0
+static int dev_metrics_show(struct seq_file* s, void* unused) {
+    struct dev_stats* sums;
+    unsigned int i;
+    size_t j;
+
+    sums = kcalloc(nr_devs, sizeof(*sums), GFP_KERNEL);
+    if (sums == NULL) {
+        return -ENOMEM;
+    }
+    for (i = 0; i < nr_devs; i++) {
+        dev_stats_sum(mydevs[i].stats, &sums[i]);
+    }
+
+    for (j = 0; j < ARRAY_SIZE(dev_stat_descs); j++) {
+        const struct dev_stat_desc* desc = &dev_stat_descs[j];
+
+        seq_printf(s, "# HELP mychardev_%s_total %s\n", desc->name, desc->help);
+        seq_printf(s, "# TYPE mychardev_%s_total counter\n", desc->name);
+        for (i = 0; i < nr_devs; i++) {
+            seq_printf(s, "mychardev_%s_total{device=\"%s\"} %llu\n",
+                       desc->name, dev_name(mydevs[i].device), dev_stat_get(&sums[i], desc));
+        }
+    }
+    kfree(sums);
+    return 0;
+}
+DEFINE_SHOW_ATTRIBUTE(dev_metrics);
+
+//Author:      Chris Martinez
+//Description: Generates the sysfs show function and attribute for one counter of struct
+//             dev_stats, read as /sys/class/myclass/<dev>/stats/<counter>
+//Date:        16 October 2026
+//Version:     1.0
+#define DEV_STAT_ATTR(field)                                                                \
+static ssize_t field##_show(struct device* device, struct device_attribute* attr, char* buf) { \
+    struct mychardev_dev* dev = dev_get_drvdata(device);                                   \
+    struct dev_stats stats;                                                                 \
+    dev_stats_sum(dev->stats, &stats);                                                      \
+    return sysfs_emit(buf, "%llu\n", stats.field);                                          \
+}                                                                                           \
+static DEVICE_ATTR_RO(field)
+
+DEV_STAT_ATTR(bytes_read);
+DEV_STAT_ATTR(records_read);
+DEV_STAT_ATTR(bytes_written);
+DEV_STAT_ATTR(records_written);
+DEV_STAT_ATTR(empty_reads);
+DEV_STAT_ATTR(blocked_writes);
+DEV_STAT_ATTR(wakeups);
+DEV_STAT_ATTR(polls);
+DEV_STAT_ATTR(drops);
+DEV_STAT_ATTR(overruns);
+DEV_STAT_ATTR(evictions);
+
+static struct attribute* dev_stats_attrs[] = {
+    &dev_attr_bytes_read.attr,
+    &dev_attr_records_read.attr,
+    &dev_attr_bytes_written.attr,
+    &dev_attr_records_written.attr,
+    &dev_attr_empty_reads.attr,
+    &dev_attr_blocked_writes.attr,
+    &dev_attr_wakeups.attr,
+    &dev_attr_polls.attr,
+    &dev_attr_drops.attr,
+    &dev_attr_overruns.attr,
+    &dev_attr_evictions.attr,
+    NULL
+};
+
+static const struct attribute_group dev_stats_group = {
+    .name  = "stats",
+    .attrs = dev_stats_attrs,
+};
+
+static const struct attribute_group* dev_groups[] = {
+    &dev_stats_group,
+    NULL
+};
+
 //Author:      Chris Martinez
 //Description: This creates the file operations structure to pass the
 //             functions needs to operate the device driver
@@ -170,32 +1649,160 @@ static struct file_operations file_ops = {
 };
 
 //Author:      Chris Martinez
-//Description: Will create the char driver within the init
-//Date:        13 April 2025
-//Version:     1.0
-static int __init mychardev_init(void) {
+//Description: Sets up one device: its ring, its cdev, its node in /dev and its debugfs directory.
+//             Minor 0 keeps the /dev/mychardev name, the rest get their minor appended.
+//             With DEV_LAZY_RING only the ring's size is set here, the first open allocates it.
+//Date:        16 October 2026
+//Version:     1.2
+static int dev_setup(struct mychardev_dev* dev, unsigned int minor) {
+    char name[DEV_NAME_LEN];
     int ret;
 
-    //First we must allocate a device number for the device driver
-    //If it fails (< 0), then we must notified the user
-    //If it succeeds, dev_num is loaded with the device number that is allocated
-    ret = alloc_chrdev_region(&dev_num, 0, 1, DEV_NAME);
+    mutex_init(&dev->lock);
+    mutex_init(&dev->wlock);
+    init_waitqueue_head(&dev->wq);
+    init_waitqueue_head(&dev->wq_space);
+    INIT_LIST_HEAD(&dev->readers);
+    INIT_LIST_HEAD(&dev->evicted);
+    INIT_WORK(&dev->scrub_work, dev_scrub_work);
+    INIT_DELAYED_WORK(&dev->free_work, dev_free_work);
+    dev->policy = overflow_policy;
+    dev->max_lag = max_lag;
+    dev->lag_action = lag_action;
+    dev->minor = minor;
+
+    dev->lat_hist = alloc_percpu(struct dev_hist);
+    dev->lock_prof = alloc_percpu(struct dev_lock_prof);
+    dev->stats = alloc_percpu(struct dev_stats);
+    if (dev->lat_hist == NULL || dev->lock_prof == NULL || dev->stats == NULL) {
+        free_percpu(dev->lat_hist);
+        free_percpu(dev->lock_prof);
+        free_percpu(dev->stats);
+        return -ENOMEM;
+    }
+
+    dev->ring.len = dev_ring_len();
+    if (!DEV_LAZY_RING) {
+        dev->ring.buf = kvmalloc(dev->ring.len, GFP_KERNEL);
+    }
+    if (!DEV_LAZY_RING && dev->ring.buf == NULL) {
+        pr_alert("mychardev: Unable to allocate a %zu byte buffer for the device.\n", dev->ring.len);
+        free_percpu(dev->lat_hist);
+        free_percpu(dev->lock_prof);
+        free_percpu(dev->stats);
+        return -ENOMEM;
+    }
+
+    //Initialize the cdev structure and add the char device to the system
+    cdev_init(&dev->cdev, &file_ops);
+    dev->cdev.owner = THIS_MODULE;
+    ret = cdev_add(&dev->cdev, MKDEV(MAJOR(dev_num), minor), 1);
     if (ret < SUCCESSFUL) {
-        pr_alert("mychardev: Unable to allocate a major number for device.\n");
+        pr_alert("mychardev: Unable to add device to the system.\n");
+        kvfree(dev->ring.buf);
+        free_percpu(dev->lat_hist);
+        free_percpu(dev->lock_prof);
+        free_percpu(dev->stats);
         return ret;
     }
 
-    //Initialize the cdev structure
-    cdev_init(&mycdev, &file_ops);
+    //Will need to create the device to /dev
+    //Will need to check if if fails via IS_ERR
+    if (minor == 0) {
+        snprintf(name, sizeof(name), "%s", DEV_NAME);
+    } else {
+        snprintf(name, sizeof(name), "%s%u", DEV_NAME, minor);
+    }
+    //The counters in stats/ come with the device, so they exist as soon as it shows up
+    dev->device = device_create_with_groups(myclass, NULL, MKDEV(MAJOR(dev_num), minor), dev,
+                                            dev_groups, "%s", name);
+    if (IS_ERR(dev->device)) {
+        pr_alert("mychardev: Unable to create a device to /dev.\n");
+        pr_alert("mychardev: Deleting cdev...\n");
+        cdev_del(&dev->cdev);
+        kvfree(dev->ring.buf);
+        free_percpu(dev->lat_hist);
+        free_percpu(dev->lock_prof);
+        free_percpu(dev->stats);
+        return PTR_ERR(dev->device);
+    }
 
-    //Add the char device to the system
+    //Statistics go in debugfs under the same name as the node in /dev.
+    //debugfs failing is not worth failing the device for.
+    dev->debugfs = debugfs_create_dir(name, mydebugfs);
+    debugfs_create_file("latency", 0444, dev->debugfs, dev, &dev_latency_fops);
+    debugfs_create_file("lock", 0444, dev->debugfs, dev, &dev_lock_fops);
+    debugfs_create_file("readers", 0444, dev->debugfs, dev, &dev_readers_fops);
+    return SUCCESSFUL;
+}
+
+//Author:      Chris Martinez
+//Description: Undoes dev_setup for one device, and frees its ring if it is still allocated
+//Date:        16 October 2026
+//Version:     1.1
+static void dev_teardown(struct mychardev_dev* dev, unsigned int minor) {
+    debugfs_remove_recursive(dev->debugfs);
+    device_destroy(myclass, MKDEV(MAJOR(dev_num), minor));
+    cdev_del(&dev->cdev);
+    cancel_work_sync(&dev->scrub_work); //no more ioctls can queue it now
+    cancel_delayed_work_sync(&dev->free_work); //nor closes this
+    kvfree(dev->ring.buf);
+    free_percpu(dev->lat_hist);
+    free_percpu(dev->lock_prof);
+    free_percpu(dev->stats);
+}
+
+//Author:      Chris Martinez
+//Description: Will create the char drivers within the init
+//Date:        13 April 2025
+//Version:     1.5
+static int __init mychardev_init(void) {
+    unsigned int i;
+    int ret;
+
+    if (DEV_PERCPU_WRITES && nr_devs == 0) {
+        nr_devs = min_t(unsigned int, num_possible_cpus(), DEV_MAX_DEVS);
+    }
+    if (nr_devs == 0 || nr_devs > DEV_MAX_DEVS || !dev_policy_valid(overflow_policy) ||
+        lag_action > MYCHARDEV_LAG_MAX || !dev_lag_limit_valid(max_lag, dev_ring_len())) {
+        pr_alert("mychardev: nr_devs must be 1 to %d, overflow_policy 0 to %d (not block in percpu, not overwrite in spsc), lag_action 0 to %d and max_lag 0 or %zu to %zu (only 0 in spsc).\n",
+                 DEV_MAX_DEVS, MYCHARDEV_POLICY_MAX, MYCHARDEV_LAG_MAX,
+                 sizeof(struct mychardev_rec_hdr), dev_ring_len());
+        return -EINVAL;
+    }
+
+    mydevs = kcalloc(nr_devs, sizeof(*mydevs), GFP_KERNEL);
+    if (mydevs == NULL) {
+        return -ENOMEM;
+    }
+
+    //Readers get a cache of their own rather than sharing a kmalloc size class. Each one
+    //starts on a cacheline of its own, so readers on different CPUs moving their cursors
+    //do not bounce each other's lines.
+    reader_cache = kmem_cache_create("mychardev_reader", sizeof(struct dev_reader), 0,
+                                     SLAB_HWCACHE_ALIGN | SLAB_ACCOUNT, NULL);
+    if (reader_cache == NULL) {
+        kfree(mydevs);
+        return -ENOMEM;
+    }
+    if (reader_reserve != 0) {
+        reader_pool = mempool_create_slab_pool(reader_reserve, reader_cache);
+        if (reader_pool == NULL) {
+            kmem_cache_destroy(reader_cache);
+            kfree(mydevs);
+            return -ENOMEM;
+        }
+    }
+
+    //First we must allocate a device number for each device
     //If it fails (< 0), then we must notified the user
-    //If succeeds, device added to the system
-    ret = cdev_add(&mycdev, dev_num, 1);
+    //If it succeeds, dev_num is loaded with the first device number that is allocated
+    ret = alloc_chrdev_region(&dev_num, 0, nr_devs, DEV_NAME);
     if (ret < SUCCESSFUL) {
-        pr_alert("mychardev: Unable to add device to the system.\n");
-        pr_alert("mychardev: Unregistering the device number....\n");
-        unregister_chrdev_region(dev_num, 1);
+        pr_alert("mychardev: Unable to allocate a major number for device.\n");
+        mempool_destroy(reader_pool);
+        kmem_cache_destroy(reader_cache);
+        kfree(mydevs);
         return ret;
     }
 
@@ -205,42 +1812,61 @@ static int __init mychardev_init(void) {
     myclass = class_create(CLASS_NAME);
     if (IS_ERR(myclass)) {
         pr_alert("mychardev: Unable to create a class.\n");
-        pr_alert("mychardev: Deleting cdev...\n");
-        cdev_del(&mycdev);
-        pr_alert("mychardev: Unregistering the device number...\n");
-        unregister_chrdev_region(dev_num, 1);
+        ret = PTR_ERR(myclass);
+        goto err_region;
     }
 
-    //Will need to create the device to /dev
-    //Will need to check if if fails via IS_ERR
-    mydevice = device_create(myclass, NULL, dev_num, NULL, DEV_NAME);
-    if (IS_ERR(mydevice)) {
-        pr_alert("mychardev: Unable to create a device to /dev.\n");
-        pr_alert("mychardev: Deleting the class...\n");
-        class_destroy(myclass);
-        pr_alert("mychardev: Deleting cdev...\n");
-        cdev_del(&mycdev);
-        pr_alert("mychardev: Unregistering the device number...\n");
-        unregister_chrdev_region(dev_num, 1);
+    //Then every device gets its ring, cdev, node in /dev and directory in debugfs
+    mydebugfs = debugfs_create_dir(DEV_NAME, NULL);
+    for (i = 0; i < nr_devs; i++) {
+        ret = dev_setup(&mydevs[i], i);
+        if (ret < SUCCESSFUL) {
+            goto err_devs;
+        }
     }
 
-    pr_info("mychardev: The Device Driver Module has been loaded to -> /dev/%s\n", DEV_NAME);
+    //The metrics file covers every device, so it only shows up once they all exist
+    debugfs_create_file("metrics", 0444, mydebugfs, NULL, &dev_metrics_fops);
+
+    pr_info("mychardev: The Device Driver Module has been loaded to -> /dev/%s (%u devices, %s)\n",
+            DEV_NAME, nr_devs, DEV_VARIANT);
     return 0;
+
+err_devs:
+    while (i-- > 0) {
+        dev_teardown(&mydevs[i], i);
+    }
+    debugfs_remove_recursive(mydebugfs);
+    pr_alert("mychardev: Deleting the class...\n");
+    class_destroy(myclass);
+err_region:
+    pr_alert("mychardev: Unregistering the device number...\n");
+    unregister_chrdev_region(dev_num, nr_devs);
+    mempool_destroy(reader_pool);
+    kmem_cache_destroy(reader_cache);
+    kfree(mydevs);
+    return ret;
 }
 
 //Author:      Chris Martinez
 //Description: Will unload the device driver module
 //Date:        14 April 2025
-//Version:     1.0
+//Version:     1.4
 static void __exit mychardev_exit(void) {
-    device_destroy(myclass, dev_num);
-    pr_alert("mychardev: Removing device from /dev...\n");
+    unsigned int i;
+
+    for (i = 0; i < nr_devs; i++) {
+        dev_teardown(&mydevs[i], i);
+    }
+    debugfs_remove_recursive(mydebugfs);
+    pr_alert("mychardev: Removing devices from /dev and deleting cdevs...\n");
     class_destroy(myclass);
     pr_alert("mychardev: Deleting the class...\n");
-    cdev_del(&mycdev);
-    pr_alert("mychardev: Deleting cdev...\n");
-    unregister_chrdev_region(dev_num, 1);
+    unregister_chrdev_region(dev_num, nr_devs);
     pr_alert("mychardev: Unregistering the device number...\n");
+    mempool_destroy(reader_pool);
+    kmem_cache_destroy(reader_cache);
+    kfree(mydevs);
     pr_info("mychardev: The Device Driver Module has been unloaded.\n");
 }
 
@@ -250,4 +1876,4 @@ module_exit(mychardev_exit);
 MODULE_AUTHOR("Chris Martinez");
 MODULE_DESCRIPTION("My First Character Driver Device");
 MODULE_LICENSE("GPL");
-MODULE_VERSION("1.0");
\ No newline at end of file
+MODULE_VERSION("1.0");
@@ -0,0 +1,89 @@
+#ifndef MYCHARDEV_H
+#define MYCHARDEV_H
+
+//Shared between the driver and the programs that use it, so it must only use
+//types and headers that exist both in the kernel and in userspace.
+#include <linux/ioctl.h>
+#include <linux/types.h>
+
+#define IOCTL_MAGIC                 'k'
+
+//What a device does when a write does not fit behind what its readers still need.
+//Set per device with IOCTL_SET_POLICY, the overflow_policy parameter is the default.
+//In the percpu build, where a write can land in any device's ring, it is set on all of them.
+//The spsc build starts devices under block and refuses overwrite.
+#define MYCHARDEV_POLICY_OVERWRITE  0 //Drop the oldest records, writers never wait (flight recorder). Not in the spsc build.
+#define MYCHARDEV_POLICY_DROP       1 //Drop the new record and count it, writers never wait
+#define MYCHARDEV_POLICY_BLOCK      2 //Writers wait for room, or get -EAGAIN with O_NONBLOCK. Not in the percpu build.
+#define MYCHARDEV_POLICY_MAX        MYCHARDEV_POLICY_BLOCK
+
+//What happens to a reader that falls more than the device's max_lag bytes behind the head
+//once the writers need its room. Set per device with IOCTL_SET_LAG_LIMIT, 0 means no limit.
+//Like the policy, the percpu build sets it on every device. The spsc build only takes 0.
+#define MYCHARDEV_LAG_SKIP          0 //The reader is skipped ahead, it sees the loss as a gap in seq
+#define MYCHARDEV_LAG_EVICT         1 //The reader is cut off, poll reports POLLERR and reads fail with -EPIPE
+#define MYCHARDEV_LAG_MAX           MYCHARDEV_LAG_EVICT
+
+struct mychardev_lag_limit {
+    __u64 max_lag; //In bytes of queued records, 0 for no limit, else from a record header up to the ring size
+    __u32 action;  //MYCHARDEV_LAG_SKIP or MYCHARDEV_LAG_EVICT
+    __u32 pad;
+};
+
+//Every write is queued as one record with a sequence number. A reader that finds a
+//gap in the sequence knows the records in between were overwritten or dropped.
+struct mychardev_reader_info {
+    __u64 next_seq; //Sequence number of the next record this reader will see
+    __u64 lost;     //Records this reader never saw, because of overruns or drops
+    __u64 overruns; //Times the writers overwrote data this reader had not read yet
+    __u64 dropped;  //Records the device dropped under MYCHARDEV_POLICY_DROP
+};
+
+//Records are read back either as one plain stream of data, the default, or each with a
+//struct mychardev_rec_hdr in front. Chosen per open file with IOCTL_SET_READ_MODE.
+#define MYCHARDEV_READ_STREAM       0
+#define MYCHARDEV_READ_RECORDS      1
+
+//In MYCHARDEV_READ_RECORDS mode a read returns whole records, each one this header and
+//then len bytes of data. The next header starts MYCHARDEV_REC_SIZE(len) bytes after this one.
+//A record too big for the read's buffer comes back cut short with MYCHARDEV_REC_TRUNCATED set.
+struct mychardev_rec_hdr {
+    __u64 seq;   //Gaps mean records were overwritten or dropped
+    __u64 ts_ns; //CLOCK_MONOTONIC time the record was queued by write
+    __u32 len;   //Bytes of data that follow the header
+    __u32 flags;
+};
+
+#define MYCHARDEV_REC_TRUNCATED     0x1
+#define MYCHARDEV_REC_LOST          0x2 //Records before this one were lost to this reader
+#define MYCHARDEV_REC_ALIGN         8
+#define MYCHARDEV_REC_SIZE(len)     ((sizeof(struct mychardev_rec_hdr) + (len) + MYCHARDEV_REC_ALIGN - 1) & \
+                                     ~(size_t)(MYCHARDEV_REC_ALIGN - 1))
+
+//IOCTL_SELF_BENCH runs iters writes and reads of len bytes through the device's own ring
+//code inside the kernel, under its lock and in the file's read mode, with memcpy in place of
+//the user copies and no syscalls. Comparing it with the same loop from userspace tells the
+//core's cost apart from the syscall and copy costs. Needs CAP_SYS_ADMIN.
+struct mychardev_self_bench {
+    __u64 iters;         //In: write and read pairs to run, at most MYCHARDEV_SELF_BENCH_MAX
+    __u32 len;           //In: bytes of data per record, must fit the ring with its header
+    __u32 pad;
+    __u64 ns;            //Out: for all the pairs together
+    __u64 cycles;        //Out: the same in CPU cycles, 0 where the CPU has no cycle counter
+    __u64 ns_per_op;     //Out: ns / iters, one op is a write and a read
+    __u64 cycles_per_op; //Out: cycles / iters
+};
+
+#define MYCHARDEV_SELF_BENCH_MAX    100000000
+
+#define IOCTL_RESET_BUF             _IO(IOCTL_MAGIC, 0)
+#define IOCTL_RESET_BUF_ZERO        _IO(IOCTL_MAGIC, 1)
+#define IOCTL_SET_POLICY            _IO(IOCTL_MAGIC, 2) //The argument is the policy itself
+#define IOCTL_GET_POLICY            _IO(IOCTL_MAGIC, 3) //Returns the policy
+#define IOCTL_GET_READER_INFO       _IOR(IOCTL_MAGIC, 4, struct mychardev_reader_info)
+#define IOCTL_SET_READ_MODE         _IO(IOCTL_MAGIC, 5) //The argument is the read mode itself
+#define IOCTL_RESET_LATENCY         _IO(IOCTL_MAGIC, 6) //Clears debugfs mychardev/<dev>/latency, needs CAP_SYS_ADMIN
+#define IOCTL_SET_LAG_LIMIT         _IOW(IOCTL_MAGIC, 7, struct mychardev_lag_limit)
+#define IOCTL_SELF_BENCH            _IOWR(IOCTL_MAGIC, 8, struct mychardev_self_bench)
+
+#endif
@@ -0,0 +1,469 @@
+//The ring and record logic behind dev_read and dev_write, kept apart from the rest of the
+//driver so the same code also builds in userspace for microbenchmarks, see
+//mychardev_core_user.h. None of it locks or sleeps: the caller holds the device's lock
+//around every call. The only ways out to the caller's memory are copy_to_user and
+//copy_from_user, which userspace maps onto plain memory.
+//
+//A push publishes the head with a release store and reads take it with an acquire load, and
+//a reader can publish how far it has got the same way with dev_cursor_publish. So a writer
+//and a reader holding different locks, as in the spsc build, still see each other's records
+//whole, as long as the writer only drops records before dev_cursor_done.
+#ifndef MYCHARDEV_CORE_H
+#define MYCHARDEV_CORE_H
+
+#ifdef __KERNEL__
+#include <linux/types.h>
+#include <linux/errno.h>
+#include <linux/stddef.h>
+#include <linux/string.h>
+#include <linux/uaccess.h>
+#include <asm/barrier.h>
+#else
+#include "mychardev_core_user.h"
+#endif
+
+#include "mychardev.h"
+
+#ifndef SUCCESSFUL
+#define SUCCESSFUL          0
+#endif
+
+//The device's buffer is used as a ring, and every write is stored in it as one record laid
+//out just like MYCHARDEV_READ_RECORDS returns it: a struct mychardev_rec_hdr, the data, and
+//zeroed padding up to MYCHARDEV_REC_SIZE. head and tail are running byte counts that
+//only grow between resets, the place in buf is the count masked by the ring's length.
+//A reset just bumps gen and empties the ring, so it costs the same for any buffer size.
+//
+//A record costs MYCHARDEV_REC_SIZE(len) of the ring and nothing anywhere else: a 16 byte
+//write takes 40 bytes, a 100 byte one 128. Small records are not worth splitting out into
+//size classed slots or a smaller header of their own. Records sit back to back, so every
+//reader walks them in order through the same few cachelines, and a records read of any
+//number of them is one copy. Anything kept in another layout would need copying record by
+//record to put back together.
+struct dev_ring {
+    char*   buf;
+    size_t  len;  //Always a power of two
+    u64     head; //Where the next record will be written
+    u64     tail; //Oldest record still held in the ring
+    u64     gen;  //Bumped on every reset
+    u64     seq;  //Sequence number the next record will get
+};
+
+//Where one reader is in the ring. Every reader has its own, so every reader sees every record.
+struct dev_cursor {
+    u64     pos;      //Position of the next record to read
+    size_t  rec_off;  //How much of the record at pos a stream read has already taken
+    u64     gen;      //Generation of the ring pos belongs to
+    u64     next_seq; //Sequence number expected next, a gap means records were lost
+    u64     lost;     //Records this reader never saw
+    u64     done;     //pos as last published for a writer that holds another lock
+};
+
+//Called for every record a read takes, with the header as it was written
+typedef void (*dev_taken_fn)(void* ctx, const struct mychardev_rec_hdr* hdr);
+
+//Author:      Chris Martinez
+//Description: Returns the smaller of two sizes. min() is a macro in the kernel and a
+//             function template in C++, so the core keeps its own.
+//Date:        16 October 2026
+//Version:     1.0
+static inline size_t dev_min_size(size_t a, size_t b) {
+    return a < b ? a : b;
+}
+
+//Author:      Chris Martinez
+//Description: Returns how much of the ring a record with len bytes of data takes up.
+//Date:        16 October 2026
+//Version:     1.0
+static inline size_t dev_rec_size(size_t len) {
+    return MYCHARDEV_REC_SIZE(len);
+}
+
+//Author:      Chris Martinez
+//Description: Copies amt bytes out of the ring starting at position pos, in two pieces
+//             when the data wraps around the end of the buffer.
+//Date:        16 October 2026
+//Version:     1.0
+static inline void dev_ring_get(const struct dev_ring* ring, u64 pos, void* dst, size_t amt) {
+    size_t off = pos & (ring->len - 1);
+    size_t first = dev_min_size(amt, ring->len - off);
+
+    memcpy(dst, ring->buf + off, first);
+    memcpy((char*)dst + first, ring->buf, amt - first);
+}
+
+//Author:      Chris Martinez
+//Description: Copies amt bytes into the ring at position pos, in two pieces
+//             when the data wraps around the end of the buffer.
+//Date:        16 October 2026
+//Version:     1.0
+static inline void dev_ring_put(struct dev_ring* ring, u64 pos, const void* src, size_t amt) {
+    size_t off = pos & (ring->len - 1);
+    size_t first = dev_min_size(amt, ring->len - off);
+
+    memcpy(ring->buf + off, src, first);
+    memcpy(ring->buf, (const char*)src + first, amt - first);
+}
+
+//Author:      Chris Martinez
+//Description: Copies amt bytes to a read's buffer. kernel says the buffer is really kernel
+//             memory, as it is for IOCTL_SELF_BENCH, and a plain memcpy does. Every caller
+//             passes kernel down from a constant, so only one of the two copies is built.
+//Date:        16 October 2026
+//Version:     1.0
+static inline int dev_copy_out(char __user* user_buf, const void* src, size_t amt, bool kernel) {
+    if (kernel) {
+        memcpy((__force void*)user_buf, src, amt);
+        return SUCCESSFUL;
+    }
+    return copy_to_user(user_buf, src, amt) != SUCCESSFUL ? -EFAULT : SUCCESSFUL;
+}
+
+//Author:      Chris Martinez
+//Description: Copies amt bytes from a write's buffer, the other way from dev_copy_out
+//Date:        16 October 2026
+//Version:     1.0
+static inline int dev_copy_in(void* dst, const char __user* user_buf, size_t amt, bool kernel) {
+    if (kernel) {
+        memcpy(dst, (__force const void*)user_buf, amt);
+        return SUCCESSFUL;
+    }
+    return copy_from_user(dst, user_buf, amt) != SUCCESSFUL ? -EFAULT : SUCCESSFUL;
+}
+
+//Author:      Chris Martinez
+//Description: Copies amt bytes starting at ring position pos to the user's buffer,
+//             in two pieces when the data wraps around the end of the buffer.
+//Date:        16 October 2026
+//Version:     1.2
+static inline int dev_copy_to_user(const struct dev_ring* ring, char __user* user_buf, u64 pos, size_t amt,
+                                   bool kernel) {
+    size_t off = pos & (ring->len - 1);
+    size_t first = dev_min_size(amt, ring->len - off);
+
+    if (dev_copy_out(user_buf, ring->buf + off, first, kernel) != SUCCESSFUL ||
+        dev_copy_out(user_buf + first, ring->buf, amt - first, kernel) != SUCCESSFUL) {
+        return -EFAULT;
+    }
+    return SUCCESSFUL;
+}
+
+//Author:      Chris Martinez
+//Description: Copies amt bytes from the user's buffer into the ring at position pos,
+//             in two pieces when the data wraps around the end of the buffer.
+//Date:        16 October 2026
+//Version:     1.2
+static inline int dev_copy_from_user(struct dev_ring* ring, u64 pos, const char __user* user_buf, size_t amt,
+                                     bool kernel) {
+    size_t off = pos & (ring->len - 1);
+    size_t first = dev_min_size(amt, ring->len - off);
+
+    if (dev_copy_in(ring->buf + off, user_buf, first, kernel) != SUCCESSFUL ||
+        dev_copy_in(ring->buf, user_buf + first, amt - first, kernel) != SUCCESSFUL) {
+        return -EFAULT;
+    }
+    return SUCCESSFUL;
+}
+
+//Author:      Chris Martinez
+//Description: Returns the sequence number of the record at pos, or the one the next
+//             record will get if pos is the head.
+//Date:        16 October 2026
+//Version:     1.0
+static inline u64 dev_ring_seq_at(const struct dev_ring* ring, u64 pos) {
+    struct mychardev_rec_hdr hdr;
+
+    if (pos == ring->head) {
+        return ring->seq;
+    }
+    dev_ring_get(ring, pos, &hdr, sizeof(hdr));
+    return hdr.seq;
+}
+
+//Author:      Chris Martinez
+//Description: Drops the oldest record in the ring.
+//Date:        16 October 2026
+//Version:     1.0
+static inline void dev_ring_discard(struct dev_ring* ring) {
+    struct mychardev_rec_hdr hdr;
+
+    dev_ring_get(ring, ring->tail, &hdr, sizeof(hdr));
+    WRITE_ONCE(ring->tail, ring->tail + dev_rec_size(hdr.len));
+}
+
+//Author:      Chris Martinez
+//Description: Empties the ring in O(1). The old bytes stay in the buffer, but bumping
+//             the generation makes every reader treat them as absent. The sequence keeps
+//             counting up, so records from before and after a reset never share a number.
+//Date:        16 October 2026
+//Version:     1.0
+static inline void dev_ring_clear(struct dev_ring* ring) {
+    WRITE_ONCE(ring->gen, ring->gen + 1);
+    WRITE_ONCE(ring->tail, 0);
+    WRITE_ONCE(ring->head, 0);
+}
+
+//Author:      Chris Martinez
+//Description: Discards the oldest records until need bytes fit. Records before done are
+//             ones every reader has finished with and always go. Past done they only go
+//             when overwrite is set, otherwise -ENOSPC is returned.
+//Date:        16 October 2026
+//Version:     1.0
+static inline int dev_ring_make_room(struct dev_ring* ring, size_t need, u64 done, bool overwrite) {
+    while (ring->head + need - ring->tail > ring->len) {
+        if (ring->tail >= done && !overwrite) {
+            return -ENOSPC;
+        }
+        dev_ring_discard(ring);
+    }
+    return SUCCESSFUL;
+}
+
+//Author:      Chris Martinez
+//Description: Queues amt bytes from the user as one record stamped with ts_ns, and sets
+//             seq to the sequence number it got. There must already be room for it, and
+//             amt must leave room for the header in the ring. kernel is as for dev_copy_in.
+//Date:        16 October 2026
+//Version:     1.2
+static inline int dev_ring_do_push(struct dev_ring* ring, const char __user* user_buf, size_t amt, u64 ts_ns,
+                                   u64* seq, bool kernel) {
+    static const char pad[MYCHARDEV_REC_ALIGN] = { 0 };
+    struct mychardev_rec_hdr hdr;
+    size_t need = dev_rec_size(amt);
+
+    //Write the data from the user first, if that fails nothing has changed
+    if (dev_copy_from_user(ring, ring->head + sizeof(hdr), user_buf, amt, kernel) != SUCCESSFUL) {
+        return -EFAULT;
+    }
+
+    //Zero the padding, so readers never see bytes left over from older records
+    dev_ring_put(ring, ring->head + sizeof(hdr) + amt, pad, need - sizeof(hdr) - amt);
+
+    //Put the header in front of the data, then move the head past it so readers can see it
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.len = amt;
+    hdr.seq = ring->seq++;
+    hdr.ts_ns = ts_ns;
+    dev_ring_put(ring, ring->head, &hdr, sizeof(hdr));
+    smp_store_release(&ring->head, ring->head + need);
+    *seq = hdr.seq;
+    return SUCCESSFUL;
+}
+
+//Author:      Chris Martinez
+//Description: dev_ring_do_push for a write from userspace
+//Date:        16 October 2026
+//Version:     1.0
+static inline int dev_ring_push(struct dev_ring* ring, const char __user* user_buf, size_t amt, u64 ts_ns, u64* seq) {
+    return dev_ring_do_push(ring, user_buf, amt, ts_ns, seq, false);
+}
+
+//Author:      Chris Martinez
+//Description: Tells a writer that holds another lock than the reader that everything before
+//             the cursor has been read. The release orders the reads of those records before
+//             it, so the writer cannot overwrite them while they are still being copied out.
+//Date:        16 October 2026
+//Version:     1.0
+static inline void dev_cursor_publish(struct dev_cursor* cur) {
+    smp_store_release(&cur->done, cur->pos);
+}
+
+//Author:      Chris Martinez
+//Description: Returns the position dev_cursor_publish last published. Everything before it
+//             is the writer's to drop, even without the reader's lock.
+//Date:        16 October 2026
+//Version:     1.0
+static inline u64 dev_cursor_done(const struct dev_cursor* cur) {
+    return smp_load_acquire(&cur->done);
+}
+
+//Author:      Chris Martinez
+//Description: Starts a cursor at the oldest record in the ring, published as done.
+//Date:        16 October 2026
+//Version:     1.1
+static inline void dev_cursor_init(struct dev_cursor* cur, const struct dev_ring* ring) {
+    cur->gen = ring->gen;
+    cur->pos = ring->tail;
+    cur->rec_off = 0;
+    cur->next_seq = dev_ring_seq_at(ring, ring->tail);
+    dev_cursor_publish(cur);
+}
+
+//Author:      Chris Martinez
+//Description: Returns where a cursor's next read will start, after resets and overruns.
+//Date:        16 October 2026
+//Version:     1.1
+static inline u64 dev_cursor_pos(const struct dev_cursor* cur, const struct dev_ring* ring) {
+    u64 tail = READ_ONCE(ring->tail);
+
+    //A cursor from an older generation will start over from the tail
+    if (cur->gen != ring->gen || cur->pos < tail) {
+        return tail;
+    }
+    return cur->pos;
+}
+
+//Author:      Chris Martinez
+//Description: Moves a cursor onto the current generation of the ring. A cursor from an
+//             older generation starts over from the oldest data still held. A cursor whose
+//             data has been overwritten is moved up to the tail, and will count the records
+//             it missed from the gap in the sequence. Returns true for an overrun.
+//Date:        16 October 2026
+//Version:     1.1
+static inline bool dev_cursor_sync(struct dev_cursor* cur, const struct dev_ring* ring) {
+    if (cur->gen != ring->gen) {
+        dev_cursor_init(cur, ring);
+    }
+    if (cur->pos < READ_ONCE(ring->tail)) {
+        cur->pos = READ_ONCE(ring->tail);
+        cur->rec_off = 0;
+        return true;
+    }
+    return false;
+}
+
+//Author:      Chris Martinez
+//Description: Notes a record taken at a cursor, counting the records it skipped over when
+//             the sequence jumps past the one it expected, then hands it to taken.
+//Date:        16 October 2026
+//Version:     1.0
+static inline void dev_cursor_take(struct dev_cursor* cur, const struct mychardev_rec_hdr* hdr,
+                                   dev_taken_fn taken, void* ctx) {
+    if (hdr->seq != cur->next_seq) {
+        cur->lost += hdr->seq - cur->next_seq;
+    }
+    cur->next_seq = hdr->seq + 1;
+    if (taken != NULL) {
+        taken(ctx, hdr);
+    }
+}
+
+//Author:      Chris Martinez
+//Description: Copies record data to the user as one plain stream. A record that does not
+//             fit is finished by the next read. Returns the amount copied, or -EFAULT if
+//             nothing could be. kernel is as for dev_copy_out.
+//Date:        16 October 2026
+//Version:     1.2
+static inline ssize_t dev_ring_do_read_stream(struct dev_ring* ring, struct dev_cursor* cur, char __user* user_buf,
+                                              size_t amt_to_copy, dev_taken_fn taken, void* ctx, bool kernel) {
+    u64 head = smp_load_acquire(&ring->head);
+    size_t amt_copied = 0;
+
+    //Copy record by record until the user's buffer is full or the reader catches up
+    while (amt_copied < amt_to_copy && cur->pos < head) {
+        struct mychardev_rec_hdr hdr;
+        size_t amt;
+
+        dev_ring_get(ring, cur->pos, &hdr, sizeof(hdr));
+        amt = dev_min_size(hdr.len - cur->rec_off, amt_to_copy - amt_copied);
+
+        //If all the data not copied to user, then there is an issue
+        //Anything already copied is still returned, otherwise exit the function with an error
+        if (dev_copy_to_user(ring, user_buf + amt_copied, cur->pos + sizeof(hdr) + cur->rec_off, amt,
+                             kernel) != SUCCESSFUL) {
+            break;
+        }
+        if (cur->rec_off == 0) {
+            dev_cursor_take(cur, &hdr, taken, ctx);
+        }
+        amt_copied += amt;
+        cur->rec_off += amt;
+
+        //Move on to the next record once this one has been read in full
+        if (cur->rec_off == hdr.len) {
+            cur->pos += dev_rec_size(hdr.len);
+            cur->rec_off = 0;
+        }
+    }
+    return amt_copied ? (ssize_t)amt_copied : -EFAULT;
+}
+
+//Author:      Chris Martinez
+//Description: dev_ring_do_read_stream for a read from userspace
+//Date:        16 October 2026
+//Version:     1.0
+static inline ssize_t dev_ring_read_stream(struct dev_ring* ring, struct dev_cursor* cur, char __user* user_buf,
+                                           size_t amt_to_copy, dev_taken_fn taken, void* ctx) {
+    return dev_ring_do_read_stream(ring, cur, user_buf, amt_to_copy, taken, ctx, false);
+}
+
+//Author:      Chris Martinez
+//Description: Copies whole records, headers included, to the user. The ring already holds
+//             them in that format, so every record that fits goes out in one copy. When not
+//             even the first record fits, it is sent cut short and marked as such.
+//             Returns the amount copied or an error. kernel is as for dev_copy_out.
+//Date:        16 October 2026
+//Version:     1.2
+static inline ssize_t dev_ring_do_read_records(struct dev_ring* ring, struct dev_cursor* cur, char __user* user_buf,
+                                               size_t amt_to_copy, dev_taken_fn taken, void* ctx, bool kernel) {
+    struct mychardev_rec_hdr hdr;
+    u64 head = smp_load_acquire(&ring->head);
+    u64 end = cur->pos;
+    size_t amt;
+
+    if (amt_to_copy < sizeof(hdr)) {
+        return -EINVAL;
+    }
+
+    //Find how many whole records fit the user's buffer
+    while (end < head) {
+        dev_ring_get(ring, end, &hdr, sizeof(hdr));
+        if (end + dev_rec_size(hdr.len) - cur->pos > amt_to_copy) {
+            break;
+        }
+        end += dev_rec_size(hdr.len);
+    }
+
+    if (end > cur->pos) {
+        amt = end - cur->pos;
+        if (dev_copy_to_user(ring, user_buf, cur->pos, amt, kernel) != SUCCESSFUL) {
+            return -EFAULT;
+        }
+        //Only now that the copy worked do the records count as read. A record that comes
+        //after a gap gets flagged in the copy the user has, the ring's copy is left alone.
+        while (cur->pos < end) {
+            char __user* user_rec = user_buf + amt - (end - cur->pos);
+
+            dev_ring_get(ring, cur->pos, &hdr, sizeof(hdr));
+            if (hdr.seq != cur->next_seq) {
+                hdr.flags |= MYCHARDEV_REC_LOST;
+                dev_copy_out(user_rec + offsetof(struct mychardev_rec_hdr, flags), &hdr.flags,
+                             sizeof(hdr.flags), kernel);
+            }
+            dev_cursor_take(cur, &hdr, taken, ctx);
+            cur->pos += dev_rec_size(hdr.len);
+        }
+        return amt;
+    }
+
+    //The first record alone is too big, so send the part of it that fits.
+    //It may only have been the padding that did not fit, then the record is whole.
+    dev_ring_get(ring, cur->pos, &hdr, sizeof(hdr));
+    end = cur->pos + dev_rec_size(hdr.len);
+    amt = dev_min_size(hdr.len, amt_to_copy - sizeof(hdr));
+    if (amt < hdr.len) {
+        hdr.len = amt;
+        hdr.flags |= MYCHARDEV_REC_TRUNCATED;
+    }
+    if (hdr.seq != cur->next_seq) {
+        hdr.flags |= MYCHARDEV_REC_LOST;
+    }
+    if (dev_copy_out(user_buf, &hdr, sizeof(hdr), kernel) != SUCCESSFUL ||
+        dev_copy_to_user(ring, user_buf + sizeof(hdr), cur->pos + sizeof(hdr), amt, kernel) != SUCCESSFUL) {
+        return -EFAULT;
+    }
+    dev_cursor_take(cur, &hdr, taken, ctx);
+    cur->pos = end;
+    return sizeof(hdr) + amt;
+}
+
+//Author:      Chris Martinez
+//Description: dev_ring_do_read_records for a read from userspace
+//Date:        16 October 2026
+//Version:     1.0
+static inline ssize_t dev_ring_read_records(struct dev_ring* ring, struct dev_cursor* cur, char __user* user_buf,
+                                            size_t amt_to_copy, dev_taken_fn taken, void* ctx) {
+    return dev_ring_do_read_records(ring, cur, user_buf, amt_to_copy, taken, ctx, false);
+}
+
+#endif
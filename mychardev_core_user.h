@@ -0,0 +1,48 @@
+//Userspace stand-ins for the few kernel interfaces mychardev_core.h uses, so the ring and
+//record logic builds as an ordinary C or C++ library. "User" memory is just memory here,
+//so the copies never fault, and the device mutex becomes a pthread mutex.
+#ifndef MYCHARDEV_CORE_USER_H
+#define MYCHARDEV_CORE_USER_H
+
+#include <errno.h>
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/types.h>
+#ifndef __cplusplus
+#include <stdbool.h>
+#endif
+
+#include <linux/types.h>
+
+typedef uint64_t            u64;
+typedef uint32_t            u32;
+
+#define __user
+#define __force
+#define READ_ONCE(x)        (*(const volatile __typeof__(x)*)&(x))
+#define WRITE_ONCE(x, val)  (*(volatile __typeof__(x)*)&(x) = (val))
+#define smp_load_acquire(p)         __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define smp_store_release(p, val)   __atomic_store_n((p), (val), __ATOMIC_RELEASE)
+
+#define copy_to_user(to, from, n)   (memcpy((to), (from), (n)), 0UL)
+#define copy_from_user(to, from, n) (memcpy((to), (from), (n)), 0UL)
+
+struct mutex {
+    pthread_mutex_t         lock;
+};
+
+static inline void mutex_init(struct mutex* lock) {
+    pthread_mutex_init(&lock->lock, NULL);
+}
+
+static inline void mutex_lock(struct mutex* lock) {
+    pthread_mutex_lock(&lock->lock);
+}
+
+static inline void mutex_unlock(struct mutex* lock) {
+    pthread_mutex_unlock(&lock->lock);
+}
+
+#endif
@@ -0,0 +1,3 @@
+//The multi producer, multi consumer build of mychardev, see mychardev_variant.h
+#define MYCHARDEV_VARIANT_MPMC
+#include "mychardev.c"
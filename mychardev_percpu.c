@@ -0,0 +1,3 @@
+//The per CPU build of mychardev, one ring per CPU, see mychardev_variant.h
+#define MYCHARDEV_VARIANT_PERCPU
+#include "mychardev.c"
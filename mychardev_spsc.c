@@ -0,0 +1,3 @@
+//The single producer, single consumer build of mychardev, see mychardev_variant.h
+#define MYCHARDEV_VARIANT_SPSC
+#include "mychardev.c"
@@ -0,0 +1,556 @@
+//KUnit tests for the ring and record core in mychardev_core.h, the code dev_read and dev_write
+//run under the device's lock. The core is tested on its own, so no device is registered and
+//mychardev.ko does not need to be loaded. The data goes through real user memory mapped
+//into the test, the same copy_to_user and copy_from_user paths a read or write takes.
+//The timed cases print ns/op to the KUnit log. See the kunit target in the Makefile.
+#include <kunit/test.h>
+#include <linux/atomic.h>
+#include <linux/completion.h>
+#include <linux/delay.h>
+#include <linux/kthread.h>
+#include <linux/ktime.h>
+#include <linux/mman.h>
+#include <linux/module.h>
+#include <linux/mutex.h>
+#include <linux/sched/mm.h>
+#include <linux/slab.h>
+#include <linux/uaccess.h>
+
+#include "mychardev_core.h"
+
+#define TEST_RING_LEN       256
+#define TEST_USER_LEN       (16 * PAGE_SIZE)
+#define TEST_WRITERS        2
+#define TEST_READERS        2
+#define TEST_PER_WRITER     20000
+#define TEST_THREAD_SECS    30
+#define TEST_PERF_LOOPS     100000
+
+//0 only reports the timed loops, anything else also fails them when slower than this
+static unsigned int max_ns_per_op = 0;
+module_param(max_ns_per_op, uint, 0644);
+MODULE_PARM_DESC(max_ns_per_op, "Fail a timed loop slower than this many ns/op (0 = only report)");
+
+//A ring with one reader, and user memory to write from and read into
+struct test_ring {
+    struct dev_ring     ring;
+    struct dev_cursor   cur;
+    char __user*        ubuf;
+    char*               kbuf;  //Where the test looks at what a read put in ubuf
+};
+
+//Author:      Chris Martinez
+//Description: Sets up a ring of len bytes, a reader at its start, and TEST_USER_LEN bytes of
+//             user memory whose first half holds the byte pattern every write copies from.
+//Date:        16 October 2026
+//Version:     1.0
+static void test_ring_init(struct kunit* test, struct test_ring* t, size_t len) {
+    unsigned long addr;
+    size_t i;
+
+    memset(t, 0, sizeof(*t));
+    t->ring.buf = kunit_kzalloc(test, len, GFP_KERNEL);
+    KUNIT_ASSERT_NOT_ERR_OR_NULL(test, t->ring.buf);
+    t->ring.len = len;
+    dev_cursor_init(&t->cur, &t->ring);
+
+    addr = kunit_vm_mmap(test, NULL, 0, TEST_USER_LEN, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, 0);
+    KUNIT_ASSERT_FALSE_MSG(test, IS_ERR_VALUE(addr), "Could not map user memory");
+    t->ubuf = (char __user*)addr;
+    t->kbuf = kunit_kzalloc(test, TEST_USER_LEN, GFP_KERNEL);
+    KUNIT_ASSERT_NOT_ERR_OR_NULL(test, t->kbuf);
+
+    for (i = 0; i < TEST_USER_LEN / 2; i++) {
+        t->kbuf[i] = i;
+    }
+    KUNIT_ASSERT_EQ(test, copy_to_user(t->ubuf, t->kbuf, TEST_USER_LEN / 2), 0UL);
+}
+
+//Author:      Chris Martinez
+//Description: Returns the user memory reads go into, past the pattern writes copy from
+//Date:        16 October 2026
+//Version:     1.0
+static char __user* test_read_buf(struct test_ring* t) {
+    return t->ubuf + TEST_USER_LEN / 2;
+}
+
+//Author:      Chris Martinez
+//Description: Writes amt bytes of the pattern as one record, starting at offset off into it.
+//             overwrite picks OVERWRITE over DROP when the ring is full of unread records.
+//             Returns what dev_ring_make_room or dev_ring_push did.
+//Date:        16 October 2026
+//Version:     1.0
+static int test_push(struct test_ring* t, size_t off, size_t amt, bool overwrite) {
+    u64 seq;
+    int ret;
+
+    ret = dev_ring_make_room(&t->ring, dev_rec_size(amt), dev_cursor_pos(&t->cur, &t->ring), overwrite);
+    if (ret != SUCCESSFUL) {
+        return ret;
+    }
+    return dev_ring_push(&t->ring, t->ubuf + off, amt, 0, &seq);
+}
+
+//Author:      Chris Martinez
+//Description: Reads up to amt bytes for the ring's reader as dev_do_read would, and copies
+//             what came back into kbuf. Returns what the read returned.
+//Date:        16 October 2026
+//Version:     1.0
+static ssize_t test_read(struct kunit* test, struct test_ring* t, size_t amt, bool records) {
+    ssize_t ret;
+
+    dev_cursor_sync(&t->cur, &t->ring);
+    if (t->cur.pos >= t->ring.head) {
+        return 0;
+    }
+    if (records) {
+        ret = dev_ring_read_records(&t->ring, &t->cur, test_read_buf(t), amt, NULL, NULL);
+    } else {
+        ret = dev_ring_read_stream(&t->ring, &t->cur, test_read_buf(t), amt, NULL, NULL);
+    }
+    if (ret > 0) {
+        KUNIT_ASSERT_EQ(test, copy_from_user(t->kbuf, test_read_buf(t), ret), 0UL);
+    }
+    return ret;
+}
+
+//Author:      Chris Martinez
+//Description: Checks amt bytes in kbuf are the pattern starting at offset off
+//Date:        16 October 2026
+//Version:     1.0
+static void test_expect_pattern(struct kunit* test, const char* buf, size_t off, size_t amt) {
+    size_t i;
+
+    for (i = 0; i < amt; i++) {
+        if (buf[i] != (char)(off + i)) {
+            KUNIT_FAIL(test, "Byte %zu of %zu is %d, not %d", i, amt, buf[i], (char)(off + i));
+            return;
+        }
+    }
+}
+
+//Author:      Chris Martinez
+//Description: Writes and reads back records of changing sizes through a small ring until it
+//             has wrapped many times, so headers and data get split across the end of it.
+//Date:        16 October 2026
+//Version:     1.0
+static void mychardev_test_wraparound(struct kunit* test) {
+    struct test_ring t;
+    size_t off, amt;
+    int i;
+
+    test_ring_init(test, &t, TEST_RING_LEN);
+
+    for (i = 0; i < 200; i++) {
+        off = i * 13 % 64;
+        amt = 1 + i * 37 % 120;
+        KUNIT_ASSERT_EQ(test, test_push(&t, off, amt, false), SUCCESSFUL);
+        KUNIT_ASSERT_EQ(test, test_read(test, &t, amt, false), (ssize_t)amt);
+        test_expect_pattern(test, t.kbuf, off, amt);
+    }
+    KUNIT_EXPECT_GT(test, t.ring.head, (u64)(20 * TEST_RING_LEN));
+    KUNIT_EXPECT_EQ(test, t.cur.next_seq, (u64)200);
+    KUNIT_EXPECT_EQ(test, t.cur.lost, (u64)0);
+}
+
+//Author:      Chris Martinez
+//Description: Reads a record in pieces with stream reads, then cut short with a records read
+//             too small for it, then with a buffer too small for a header at all
+//Date:        16 October 2026
+//Version:     1.0
+static void mychardev_test_partial_read(struct kunit* test) {
+    struct mychardev_rec_hdr hdr;
+    struct test_ring t;
+
+    test_ring_init(test, &t, TEST_RING_LEN);
+
+    KUNIT_ASSERT_EQ(test, test_push(&t, 0, 100, false), SUCCESSFUL);
+    KUNIT_EXPECT_EQ(test, test_read(test, &t, 30, false), (ssize_t)30);
+    test_expect_pattern(test, t.kbuf, 0, 30);
+    KUNIT_EXPECT_EQ(test, t.cur.rec_off, (size_t)30);
+    KUNIT_EXPECT_EQ(test, test_read(test, &t, 30, false), (ssize_t)30);
+    test_expect_pattern(test, t.kbuf, 30, 30);
+    KUNIT_EXPECT_EQ(test, test_read(test, &t, 1000, false), (ssize_t)40);
+    test_expect_pattern(test, t.kbuf, 60, 40);
+    KUNIT_EXPECT_EQ(test, t.cur.rec_off, (size_t)0);
+    KUNIT_EXPECT_EQ(test, t.cur.pos, t.ring.head);
+
+    KUNIT_ASSERT_EQ(test, test_push(&t, 0, 100, false), SUCCESSFUL);
+    KUNIT_EXPECT_EQ(test, test_read(test, &t, sizeof(hdr) - 1, true), (ssize_t)-EINVAL);
+    KUNIT_EXPECT_EQ(test, test_read(test, &t, sizeof(hdr) + 10, true), (ssize_t)(sizeof(hdr) + 10));
+    memcpy(&hdr, t.kbuf, sizeof(hdr));
+    KUNIT_EXPECT_EQ(test, hdr.len, 10U);
+    KUNIT_EXPECT_EQ(test, hdr.seq, (u64)1);
+    KUNIT_EXPECT_TRUE(test, hdr.flags & MYCHARDEV_REC_TRUNCATED);
+    test_expect_pattern(test, t.kbuf + sizeof(hdr), 0, 10);
+    KUNIT_EXPECT_EQ(test, t.cur.pos, t.ring.head);
+}
+
+//Author:      Chris Martinez
+//Description: A write whose user buffer faults must leave the ring as it was, and the next
+//             write must still get the next sequence number
+//Date:        16 October 2026
+//Version:     1.0
+static void mychardev_test_partial_write(struct kunit* test) {
+    struct test_ring t;
+    u64 head, seq;
+
+    test_ring_init(test, &t, TEST_RING_LEN);
+    KUNIT_ASSERT_EQ(test, test_push(&t, 0, 50, false), SUCCESSFUL);
+    head = t.ring.head;
+
+    //The start of the address space is never mapped, so the copy from it faults
+    KUNIT_EXPECT_EQ(test, dev_ring_push(&t.ring, (const char __user*)16, 50, 0, &seq), -EFAULT);
+    KUNIT_EXPECT_EQ(test, t.ring.head, head);
+    KUNIT_EXPECT_EQ(test, t.ring.seq, (u64)1);
+
+    KUNIT_ASSERT_EQ(test, test_push(&t, 0, 50, false), SUCCESSFUL);
+    KUNIT_EXPECT_EQ(test, test_read(test, &t, 50, false), (ssize_t)50);
+    KUNIT_EXPECT_EQ(test, test_read(test, &t, 50, false), (ssize_t)50);
+    KUNIT_EXPECT_EQ(test, t.cur.lost, (u64)0);
+}
+
+//Author:      Chris Martinez
+//Description: With OVERWRITE, writing three ring's worth past a reader that never reads
+//             keeps only the newest records, and the reader counts every one it missed and
+//             sees the first record after the gap flagged
+//Date:        16 October 2026
+//Version:     1.0
+static void mychardev_test_overwrite(struct kunit* test) {
+    struct mychardev_rec_hdr hdr;
+    struct test_ring t;
+    size_t held;
+    ssize_t ret;
+    int i;
+
+    test_ring_init(test, &t, TEST_RING_LEN);
+
+    for (i = 0; i < 3 * TEST_RING_LEN / dev_rec_size(32); i++) {
+        KUNIT_ASSERT_EQ(test, test_push(&t, i, 32, true), SUCCESSFUL);
+    }
+    held = (t.ring.head - t.ring.tail) / dev_rec_size(32);
+    KUNIT_EXPECT_EQ(test, held, (size_t)(TEST_RING_LEN / dev_rec_size(32)));
+    KUNIT_EXPECT_TRUE(test, dev_cursor_sync(&t.cur, &t.ring));
+
+    ret = test_read(test, &t, TEST_RING_LEN, true);
+    KUNIT_EXPECT_EQ(test, ret, (ssize_t)(held * dev_rec_size(32)));
+    memcpy(&hdr, t.kbuf, sizeof(hdr));
+    KUNIT_EXPECT_TRUE(test, hdr.flags & MYCHARDEV_REC_LOST);
+    KUNIT_EXPECT_EQ(test, hdr.seq, (u64)(i - held));
+    test_expect_pattern(test, t.kbuf + sizeof(hdr), i - held, 32);
+    memcpy(&hdr, t.kbuf + dev_rec_size(32), sizeof(hdr));
+    KUNIT_EXPECT_FALSE(test, hdr.flags & MYCHARDEV_REC_LOST);
+    KUNIT_EXPECT_EQ(test, t.cur.lost, (u64)(i - held));
+}
+
+//Author:      Chris Martinez
+//Description: Without OVERWRITE, a full ring refuses the write rather than drop what the
+//             reader has not seen, and has room again once the reader catches up. DROP and
+//             BLOCK both start from this -ENOSPC, they only differ in what dev_write does next.
+//Date:        16 October 2026
+//Version:     1.0
+static void mychardev_test_drop(struct kunit* test) {
+    struct test_ring t;
+    int i = 0;
+
+    test_ring_init(test, &t, TEST_RING_LEN);
+
+    while (test_push(&t, 0, 32, false) == SUCCESSFUL) {
+        i++;
+    }
+    KUNIT_EXPECT_EQ(test, test_push(&t, 0, 32, false), -ENOSPC);
+    KUNIT_EXPECT_EQ(test, t.ring.tail, (u64)0);
+    KUNIT_EXPECT_EQ(test, i, (int)(TEST_RING_LEN / dev_rec_size(32)));
+
+    KUNIT_EXPECT_EQ(test, test_read(test, &t, TEST_RING_LEN, true), (ssize_t)(i * dev_rec_size(32)));
+    KUNIT_EXPECT_EQ(test, t.cur.lost, (u64)0);
+    KUNIT_EXPECT_EQ(test, test_push(&t, 0, 32, false), SUCCESSFUL);
+    KUNIT_EXPECT_EQ(test, test_read(test, &t, 32, false), (ssize_t)32);
+}
+
+//Author:      Chris Martinez
+//Description: A reset empties the ring for a reader part way through it, and the records
+//             after it carry on the sequence without counting the dropped ones as lost
+//Date:        16 October 2026
+//Version:     1.0
+static void mychardev_test_reset(struct kunit* test) {
+    struct test_ring t;
+    u64 gen;
+    int i;
+
+    test_ring_init(test, &t, TEST_RING_LEN);
+
+    for (i = 0; i < 3; i++) {
+        KUNIT_ASSERT_EQ(test, test_push(&t, 0, 16, false), SUCCESSFUL);
+    }
+    KUNIT_EXPECT_EQ(test, test_read(test, &t, 16, false), (ssize_t)16);
+    gen = t.ring.gen;
+
+    dev_ring_clear(&t.ring);
+    KUNIT_EXPECT_EQ(test, t.ring.gen, gen + 1);
+    KUNIT_EXPECT_EQ(test, dev_cursor_pos(&t.cur, &t.ring), (u64)0);
+    KUNIT_EXPECT_EQ(test, test_read(test, &t, 16, false), (ssize_t)0);
+    KUNIT_EXPECT_EQ(test, t.cur.next_seq, (u64)3);
+
+    KUNIT_ASSERT_EQ(test, test_push(&t, 5, 16, false), SUCCESSFUL);
+    KUNIT_EXPECT_EQ(test, test_read(test, &t, 16, false), (ssize_t)16);
+    test_expect_pattern(test, t.kbuf, 5, 16);
+    KUNIT_EXPECT_EQ(test, t.cur.next_seq, (u64)4);
+    KUNIT_EXPECT_EQ(test, t.cur.lost, (u64)0);
+}
+
+//What every writer puts in its records, so the readers can check the order they arrive in
+struct test_msg {
+    u32 writer;
+    u32 n;
+};
+
+struct test_shared;
+
+//What each kthread is started with, writers and readers are numbered from 0 on their own
+struct test_thread {
+    struct test_shared* s;
+    int                 id;
+};
+
+//A ring shared by writer and reader kthreads behind a mutex, as the locked device shares it
+struct test_shared {
+    struct mm_struct*   mm;
+    struct mutex        lock;
+    struct test_ring    t;
+    struct dev_cursor   cur[TEST_READERS];
+    struct test_thread  threads[TEST_WRITERS + TEST_READERS];
+    atomic_t            failures;
+    unsigned long       deadline;
+    struct completion   done;
+    atomic_t            running;
+};
+
+//Author:      Chris Martinez
+//Description: Returns the position of the reader furthest behind, what dev_min_cursor
+//             works out for the device
+//Date:        16 October 2026
+//Version:     1.0
+static u64 test_min_cursor(struct test_shared* s) {
+    u64 min = s->t.ring.head;
+    int i;
+
+    for (i = 0; i < TEST_READERS; i++) {
+        min = dev_min_size(min, dev_cursor_pos(&s->cur[i], &s->t.ring));
+    }
+    return min;
+}
+
+//Author:      Chris Martinez
+//Description: Lets the test know one more thread is done
+//Date:        16 October 2026
+//Version:     1.0
+static void test_thread_exit(struct test_shared* s) {
+    kthread_unuse_mm(s->mm);
+    if (atomic_dec_and_test(&s->running)) {
+        complete(&s->done);
+    }
+}
+
+//Author:      Chris Martinez
+//Description: Writes TEST_PER_WRITER numbered messages, waiting for room when the readers
+//             fall behind, as BLOCK does
+//Date:        16 October 2026
+//Version:     1.0
+static int test_writer(void* data) {
+    struct test_thread* thread = data;
+    struct test_shared* s = thread->s;
+    int id = thread->id;
+    char __user* src = s->t.ubuf + id * sizeof(struct test_msg);
+    struct test_msg msg = { .writer = id };
+    u64 seq;
+    int ret;
+
+    kthread_use_mm(s->mm);
+    while (msg.n < TEST_PER_WRITER) {
+        if (time_after(jiffies, s->deadline) || copy_to_user(src, &msg, sizeof(msg)) != 0) {
+            atomic_inc(&s->failures);
+            break;
+        }
+        mutex_lock(&s->lock);
+        ret = dev_ring_make_room(&s->t.ring, dev_rec_size(sizeof(msg)), test_min_cursor(s), false);
+        if (ret == SUCCESSFUL) {
+            ret = dev_ring_push(&s->t.ring, src, sizeof(msg), 0, &seq);
+        }
+        mutex_unlock(&s->lock);
+
+        if (ret == SUCCESSFUL) {
+            msg.n++;
+        } else if (ret == -ENOSPC) {
+            usleep_range(10, 50);
+        } else {
+            atomic_inc(&s->failures);
+            break;
+        }
+    }
+    test_thread_exit(s);
+    return 0;
+}
+
+//Author:      Chris Martinez
+//Description: Reads every message with records reads, checking none are lost and that each
+//             writer's come in the order it wrote them
+//Date:        16 October 2026
+//Version:     1.0
+static int test_reader(void* data) {
+    struct test_thread* thread = data;
+    struct test_shared* s = thread->s;
+    int id = thread->id;
+    struct dev_cursor* cur = &s->cur[id];
+    char __user* dst = s->t.ubuf + PAGE_SIZE * (1 + id);
+    u32 next[TEST_WRITERS] = { 0 };
+    u64 got = 0;
+    char* buf;
+    ssize_t ret;
+
+    buf = kmalloc(PAGE_SIZE, GFP_KERNEL);
+    kthread_use_mm(s->mm);
+    while (buf != NULL && got < TEST_WRITERS * TEST_PER_WRITER && !time_after(jiffies, s->deadline)) {
+        size_t off;
+
+        mutex_lock(&s->lock);
+        dev_cursor_sync(cur, &s->t.ring);
+        ret = cur->pos < s->t.ring.head ?
+              dev_ring_read_records(&s->t.ring, cur, dst, PAGE_SIZE, NULL, NULL) : 0;
+        mutex_unlock(&s->lock);
+
+        if (ret == 0) {
+            usleep_range(10, 50);
+            continue;
+        }
+        if (ret < 0 || copy_from_user(buf, dst, ret) != 0) {
+            break;
+        }
+        for (off = 0; off < (size_t)ret; off += dev_rec_size(sizeof(struct test_msg))) {
+            struct mychardev_rec_hdr* hdr = (struct mychardev_rec_hdr*)(buf + off);
+            struct test_msg* msg = (struct test_msg*)(hdr + 1);
+
+            if (hdr->len != sizeof(*msg) || hdr->flags != 0 || msg->writer >= TEST_WRITERS ||
+                msg->n != next[msg->writer]) {
+                atomic_inc(&s->failures);
+                goto out;
+            }
+            next[msg->writer]++;
+            got++;
+        }
+    }
+out:
+    if (got != TEST_WRITERS * TEST_PER_WRITER || cur->lost != 0) {
+        atomic_inc(&s->failures);
+    }
+    kfree(buf);
+    test_thread_exit(s);
+    return 0;
+}
+
+//Author:      Chris Martinez
+//Description: Runs writer and reader kthreads against one ring, each reader seeing every
+//             message, and times the whole exchange
+//Date:        16 October 2026
+//Version:     1.0
+static void mychardev_test_concurrent(struct kunit* test) {
+    struct test_shared* s;
+    u64 start, ns;
+    int i;
+
+    s = kunit_kzalloc(test, sizeof(*s), GFP_KERNEL);
+    KUNIT_ASSERT_NOT_ERR_OR_NULL(test, s);
+    test_ring_init(test, &s->t, 4096);
+    s->mm = current->mm;
+    mutex_init(&s->lock);
+    init_completion(&s->done);
+    for (i = 0; i < TEST_READERS; i++) {
+        dev_cursor_init(&s->cur[i], &s->t.ring);
+    }
+    s->deadline = jiffies + TEST_THREAD_SECS * HZ;
+    atomic_set(&s->running, TEST_WRITERS + TEST_READERS);
+
+    start = ktime_get_ns();
+    for (i = 0; i < TEST_WRITERS + TEST_READERS; i++) {
+        struct test_thread* thread = &s->threads[i];
+        struct task_struct* task;
+
+        thread->s = s;
+        thread->id = i < TEST_WRITERS ? i : i - TEST_WRITERS;
+        task = i < TEST_WRITERS ? kthread_run(test_writer, thread, "mychardev_tw%d", thread->id) :
+                                  kthread_run(test_reader, thread, "mychardev_tr%d", thread->id);
+
+        //Threads that never started will never finish, so count them off here
+        if (IS_ERR(task)) {
+            atomic_inc(&s->failures);
+            if (atomic_dec_and_test(&s->running)) {
+                complete(&s->done);
+            }
+        }
+    }
+    wait_for_completion(&s->done);
+    ns = ktime_get_ns() - start;
+
+    KUNIT_EXPECT_EQ(test, atomic_read(&s->failures), 0);
+    kunit_info(test, "%d writers, %d readers: %llu ns/msg\n", TEST_WRITERS, TEST_READERS,
+               ns / (TEST_WRITERS * TEST_PER_WRITER));
+}
+
+//Author:      Chris Martinez
+//Description: Times a write and a read of one record, with the reader always keeping up,
+//             and reports ns/op for a range of sizes in both read modes
+//Date:        16 October 2026
+//Version:     1.0
+static void mychardev_test_perf(struct kunit* test) {
+    static const size_t sizes[] = { 8, 64, 512, 4096 };
+    struct test_ring t;
+    u64 start, ns;
+    size_t i;
+    int n, records;
+
+    test_ring_init(test, &t, 1 << 16);
+
+    for (records = 0; records < 2; records++) {
+        for (i = 0; i < ARRAY_SIZE(sizes); i++) {
+            start = ktime_get_ns();
+            for (n = 0; n < TEST_PERF_LOOPS; n++) {
+                test_push(&t, 0, sizes[i], false);
+                if (records) {
+                    dev_ring_read_records(&t.ring, &t.cur, test_read_buf(&t), dev_rec_size(sizes[i]), NULL, NULL);
+                } else {
+                    dev_ring_read_stream(&t.ring, &t.cur, test_read_buf(&t), sizes[i], NULL, NULL);
+                }
+            }
+            ns = (ktime_get_ns() - start) / TEST_PERF_LOOPS;
+
+            kunit_info(test, "write+read %s %4zu B: %llu ns/op\n", records ? "records" : "stream ", sizes[i], ns);
+            KUNIT_EXPECT_EQ(test, t.cur.lost, (u64)0);
+            if (max_ns_per_op != 0) {
+                KUNIT_EXPECT_LE(test, ns, (u64)max_ns_per_op);
+            }
+        }
+    }
+}
+
+static struct kunit_case mychardev_test_cases[] = {
+    KUNIT_CASE(mychardev_test_wraparound),
+    KUNIT_CASE(mychardev_test_partial_read),
+    KUNIT_CASE(mychardev_test_partial_write),
+    KUNIT_CASE(mychardev_test_overwrite),
+    KUNIT_CASE(mychardev_test_drop),
+    KUNIT_CASE(mychardev_test_reset),
+    KUNIT_CASE_SLOW(mychardev_test_concurrent),
+    KUNIT_CASE_SLOW(mychardev_test_perf),
+    {}
+};
+
+static struct kunit_suite mychardev_test_suite = {
+    .name = "mychardev",
+    .test_cases = mychardev_test_cases,
+};
+
+kunit_test_suite(mychardev_test_suite);
+
+MODULE_LICENSE("GPL");
+MODULE_AUTHOR("Chris Martinez");
+MODULE_DESCRIPTION("KUnit tests for the mychardev ring core");
@@ -0,0 +1,103 @@
+//Tracepoints for the read, write, poll, wakeup and ioctl paths of mychardev.
+//They show up under /sys/kernel/tracing/events/mychardev/ and are usable from
+//perf, ftrace and bpftrace. Until one is turned on it costs a patched out jump.
+#undef TRACE_SYSTEM
+#define TRACE_SYSTEM mychardev
+
+#if !defined(_MYCHARDEV_TRACE_H) || defined(TRACE_HEADER_MULTI_READ)
+#define _MYCHARDEV_TRACE_H
+
+#include <linux/tracepoint.h>
+
+//depth is how far behind the head the file is for a read, and how full the ring is for a
+//write, both in bytes. seq is the next record the reader will see, or the record written.
+DECLARE_EVENT_CLASS(mychardev_rw,
+    TP_PROTO(unsigned int minor, size_t requested, ssize_t ret, u64 depth, u64 seq),
+    TP_ARGS(minor, requested, ret, depth, seq),
+    TP_STRUCT__entry(
+        __field(unsigned int, minor)
+        __field(size_t, requested)
+        __field(ssize_t, ret)
+        __field(u64, depth)
+        __field(u64, seq)
+    ),
+    TP_fast_assign(
+        __entry->minor = minor;
+        __entry->requested = requested;
+        __entry->ret = ret;
+        __entry->depth = depth;
+        __entry->seq = seq;
+    ),
+    TP_printk("minor=%u requested=%zu ret=%zd depth=%llu seq=%llu",
+              __entry->minor, __entry->requested, __entry->ret, __entry->depth, __entry->seq)
+);
+
+DEFINE_EVENT(mychardev_rw, mychardev_read,
+    TP_PROTO(unsigned int minor, size_t requested, ssize_t ret, u64 depth, u64 seq),
+    TP_ARGS(minor, requested, ret, depth, seq)
+);
+
+DEFINE_EVENT(mychardev_rw, mychardev_write,
+    TP_PROTO(unsigned int minor, size_t requested, ssize_t ret, u64 depth, u64 seq),
+    TP_ARGS(minor, requested, ret, depth, seq)
+);
+
+TRACE_EVENT(mychardev_poll,
+    TP_PROTO(unsigned int minor, unsigned int mask, u64 depth),
+    TP_ARGS(minor, mask, depth),
+    TP_STRUCT__entry(
+        __field(unsigned int, minor)
+        __field(unsigned int, mask)
+        __field(u64, depth)
+    ),
+    TP_fast_assign(
+        __entry->minor = minor;
+        __entry->mask = mask;
+        __entry->depth = depth;
+    ),
+    TP_printk("minor=%u mask=0x%x depth=%llu", __entry->minor, __entry->mask, __entry->depth)
+);
+
+//Fired by dev_write right before it wakes the readers for the record with this seq
+TRACE_EVENT(mychardev_wakeup,
+    TP_PROTO(unsigned int minor, u64 seq, u64 depth),
+    TP_ARGS(minor, seq, depth),
+    TP_STRUCT__entry(
+        __field(unsigned int, minor)
+        __field(u64, seq)
+        __field(u64, depth)
+    ),
+    TP_fast_assign(
+        __entry->minor = minor;
+        __entry->seq = seq;
+        __entry->depth = depth;
+    ),
+    TP_printk("minor=%u seq=%llu depth=%llu", __entry->minor, __entry->seq, __entry->depth)
+);
+
+TRACE_EVENT(mychardev_ioctl,
+    TP_PROTO(unsigned int minor, unsigned int cmd, unsigned long arg, long ret),
+    TP_ARGS(minor, cmd, arg, ret),
+    TP_STRUCT__entry(
+        __field(unsigned int, minor)
+        __field(unsigned int, cmd)
+        __field(unsigned long, arg)
+        __field(long, ret)
+    ),
+    TP_fast_assign(
+        __entry->minor = minor;
+        __entry->cmd = cmd;
+        __entry->arg = arg;
+        __entry->ret = ret;
+    ),
+    TP_printk("minor=%u cmd=0x%x arg=0x%lx ret=%ld", __entry->minor, __entry->cmd, __entry->arg, __entry->ret)
+);
+
+#endif //_MYCHARDEV_TRACE_H
+
+//The header lives next to mychardev.c rather than in include/trace/events
+#undef TRACE_INCLUDE_PATH
+#define TRACE_INCLUDE_PATH .
+#undef TRACE_INCLUDE_FILE
+#define TRACE_INCLUDE_FILE mychardev_trace
+#include <trace/define_trace.h>
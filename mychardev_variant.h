@@ -0,0 +1,84 @@
+//Picks the concurrency model mychardev is built for. The same source is compiled once per
+//model by the variants target of the Makefile, through the small mychardev_<model>.c files
+//that define one of these and include mychardev.c. Every knob below is a constant, so the
+//checks for the models a build is not for fold away and its hot path is straight line code.
+//
+//locked, mpmc and percpu keep each ring behind its device's mutex. mpmc only differs from
+//locked in how writers wait for room, so its benchmark numbers measure that, not a different
+//locking scheme, and percpu only changes which lock a write takes. spsc is the one build whose
+//writer and reader never share a lock.
+//
+//  locked  One device mutex and any number of readers and writers. The plain mychardev.ko.
+//  spsc    One reader and one writer per device, more opens get -EBUSY. The writer only takes
+//          the device's write lock and the reader only the device's mutex, which each just
+//          keep out opens, closes and ioctls. The ring's head is published with a release
+//          store, and the reader's cursor the same way, so neither side waits on the other.
+//          The writer never takes records the reader has not finished with, so overwrite
+//          and the lag limit are refused and devices start out under block. Positions are
+//          64 bit and read without a lock, so this build needs a 64 bit kernel.
+//  mpmc    Any number of readers and writers. Writers waiting for room queue up exclusively
+//          and hand the wakeup on, so freeing a little room does not wake all of them.
+//  percpu  Every write goes to the ring of the CPU it runs on, whatever device it was made
+//          through, so writers on different CPUs never share a lock. There is one device
+//          per CPU unless nr_devs says otherwise, readers pick a CPU by opening its device.
+//          A write can land in any ring, so rings are never freed while idle, see DEV_LAZY_RING,
+//          the overflow policy and lag limit are set on every device at once, and writers
+//          never wait for room, as there is no telling which ring to wait on.
+//
+//Only one variant can be loaded at a time, they all register the same names.
+#ifndef MYCHARDEV_VARIANT_H
+#define MYCHARDEV_VARIANT_H
+
+#include <linux/limits.h>
+
+#if defined(MYCHARDEV_VARIANT_SPSC)
+#define DEV_VARIANT                 "spsc"
+#define DEV_MAX_READERS             1
+#define DEV_MAX_WRITERS             1
+#define DEV_EXCLUSIVE_SPACE_WAIT    0
+#define DEV_PERCPU_WRITES           0
+#define DEV_LAZY_RING               1 //Rings come with the first open and go free_delay_ms after the last close
+#define DEV_LOCKLESS_RING           1 //Writer and reader each take their own lock, see above
+#elif defined(MYCHARDEV_VARIANT_MPMC)
+#define DEV_VARIANT                 "mpmc"
+#define DEV_MAX_READERS             UINT_MAX //No limit
+#define DEV_MAX_WRITERS             UINT_MAX
+#define DEV_EXCLUSIVE_SPACE_WAIT    1
+#define DEV_PERCPU_WRITES           0
+#define DEV_LAZY_RING               1
+#define DEV_LOCKLESS_RING           0
+#elif defined(MYCHARDEV_VARIANT_PERCPU)
+#define DEV_VARIANT                 "percpu"
+#define DEV_MAX_READERS             UINT_MAX
+#define DEV_MAX_WRITERS             UINT_MAX
+#define DEV_EXCLUSIVE_SPACE_WAIT    0
+#define DEV_PERCPU_WRITES           1
+#define DEV_LAZY_RING               0
+#define DEV_LOCKLESS_RING           0
+#else
+#define MYCHARDEV_VARIANT_LOCKED
+#define DEV_VARIANT                 "locked"
+#define DEV_MAX_READERS             UINT_MAX
+#define DEV_MAX_WRITERS             UINT_MAX
+#define DEV_EXCLUSIVE_SPACE_WAIT    0
+#define DEV_PERCPU_WRITES           0
+#define DEV_LAZY_RING               1
+#define DEV_LOCKLESS_RING           0
+#endif
+
+//The policy new devices start with when overflow_policy is not given. The spsc writer cannot
+//overwrite what the reader may be copying, so it waits for room instead.
+#if DEV_LOCKLESS_RING
+#define DEV_POLICY_DEFAULT          MYCHARDEV_POLICY_BLOCK
+#else
+#define DEV_POLICY_DEFAULT          MYCHARDEV_POLICY_OVERWRITE
+#endif
+
+//The per CPU build makes one device per CPU by default, which nr_devs 0 stands for
+#if DEV_PERCPU_WRITES
+#define DEV_NR_DEVS_DEFAULT         0
+#else
+#define DEV_NR_DEVS_DEFAULT         1
+#endif
+
+#endif
@@ -0,0 +1,62 @@
+#!/bin/sh
+# Runs inside the VM run-bench.sh boots. Loads each build of mychardev in turn, runs the
+# benchmarks against it and writes one CSV per benchmark to OUT, then runs the throughput
+# benchmark over the standard IPC primitives once for a baseline. Any other arguments are
+# passed to every mychardev_bench run.
+set -u
+
+REPO=$1
+OUT=$2
+shift 2
+BENCH=$REPO/bench/mychardev_bench
+PINGPONG=$REPO/bench/mychardev_pingpong
+SELFBENCH=$REPO/bench/mychardev_selfbench
+
+{
+    uname -a
+    echo "online cpus: $(cat /sys/devices/system/cpu/online)"
+    echo "online nodes: $(cat /sys/devices/system/node/online)"
+    grep MemTotal /proc/meminfo
+} > "$OUT/guest.txt"
+
+# Say what each build changes next to its numbers, see mychardev_variant.h, as mpmc keeps the
+# plain module's lock and only spsc splits it
+cat > "$OUT/variants.txt" <<EOF
+mychardev: one mutex per device, any readers and writers, blocked writers all wake
+mychardev_spsc: one reader and one writer per device, each with its own lock, no overwrite
+mychardev_mpmc: as mychardev, but blocked writers wake one at a time
+mychardev_percpu: one mutex per CPU's ring, writes go to the current CPU's, writers never block
+EOF
+
+# Records a benchmark that failed without stopping the others
+failed() {
+    echo "$1" | tee -a "$OUT/errors.txt" >&2
+}
+
+for variant in mychardev mychardev_spsc mychardev_mpmc mychardev_percpu; do
+    # Two devices, so the ping-pong has one for each direction. In the percpu build every
+    # write goes to the ring of its CPU, which with two devices is still one per direction.
+    if ! insmod "$REPO/$variant.ko" nr_devs=2 buf_len=1048576; then
+        failed "$variant: insmod failed"
+        continue
+    fi
+    udevadm settle 2>/dev/null || sleep 1
+
+    # The percpu build never makes writers wait, so it runs under its own default policy
+    policy=
+    if [ "$variant" = mychardev_percpu ]; then
+        policy="-P overwrite"
+    fi
+
+    "$BENCH" $policy "$@" > "$OUT/$variant-throughput.csv" || failed "$variant: throughput failed"
+    # The spsc build takes one writer and one reader per device, so it has nothing to scale
+    if [ "$variant" != mychardev_spsc ]; then
+        "$BENCH" -S both -s 64,4k $policy "$@" > "$OUT/$variant-scaling.csv" || failed "$variant: scaling failed"
+    fi
+    "$PINGPONG" > "$OUT/$variant-pingpong.csv" || failed "$variant: pingpong failed"
+    "$SELFBENCH" > "$OUT/$variant-selfbench.csv" || failed "$variant: selfbench failed"
+
+    rmmod "$variant" || failed "$variant: rmmod failed"
+done
+
+"$BENCH" -T pipe,unix,mqueue,eventfd "$@" > "$OUT/baseline.csv" || failed "baseline failed"
@@ -0,0 +1,72 @@
+#!/bin/sh
+# Builds mychardev and the benchmarks against a pinned kernel, boots that kernel in QEMU
+# with virtme-ng on a fixed CPU, memory and NUMA layout, and runs vm/guest-bench.sh in it.
+# The CSVs land in OUT, one directory per run, so runs before and after a change can be
+# diffed. Run it through "make vm-bench", which passes the settings below in.
+#
+# Needs virtme-ng 1.23 or later (for --numa), QEMU, and KVM for sensible numbers.
+set -eu
+
+REPO=$(cd "$(dirname "$0")/.." && pwd)
+KVER=${KVER:-v6.12}
+KSRC=${KSRC:-$REPO/vm/linux-$KVER}
+KGIT=${KGIT:-https://git.kernel.org/pub/scm/linux/kernel/git/stable/linux.git}
+CPUS=${CPUS:-4}
+MEM_MB=${MEM_MB:-4096}
+NODES=${NODES:-2}
+HOST_CPUS=${HOST_CPUS:-}
+LABEL=${LABEL:-$(git -C "$REPO" describe --always --dirty)}
+OUT=${OUT:-$REPO/results}/$LABEL
+BENCH_ARGS=${BENCH_ARGS:-}
+
+if [ $((CPUS % NODES)) -ne 0 ] || [ $((MEM_MB % NODES)) -ne 0 ]; then
+    echo "run-bench: CPUS and MEM_MB must split evenly over $NODES nodes" >&2
+    exit 1
+fi
+
+# The kernel is fetched at KVER once. A tree that is already there is never moved, if it is
+# at some other version the run stops rather than give numbers for the wrong kernel.
+if [ ! -d "$KSRC" ]; then
+    git clone --depth 1 --branch "$KVER" "$KGIT" "$KSRC"
+fi
+at=$(git -C "$KSRC" describe --tags --exact-match 2>/dev/null || git -C "$KSRC" rev-parse HEAD)
+if [ "$at" != "$KVER" ]; then
+    echo "run-bench: $KSRC is at $at, not $KVER" >&2
+    exit 1
+fi
+
+(cd "$KSRC" && vng --build --config "$REPO/vm/kconfig")
+make -C "$KSRC" M="$REPO" MYCHARDEV_VARIANTS=1 modules
+make -C "$REPO/bench" mychardev_bench mychardev_pingpong mychardev_selfbench
+
+# The guest's CPUs and memory are split evenly over the nodes, CPUs in order
+numa=""
+node=0
+while [ $node -lt "$NODES" ]; do
+    first=$((node * CPUS / NODES))
+    last=$(((node + 1) * CPUS / NODES - 1))
+    numa="$numa --numa $((MEM_MB / NODES))M,cpus=$first-$last"
+    node=$((node + 1))
+done
+
+mkdir -p "$OUT"
+{
+    echo "label=$LABEL"
+    echo "kernel=$KVER"
+    echo "cpus=$CPUS mem_mb=$MEM_MB nodes=$NODES host_cpus=${HOST_CPUS:-any}"
+    echo "bench_args=$BENCH_ARGS"
+    echo "host=$(uname -srm)"
+    grep -m1 "model name" /proc/cpuinfo || true
+} > "$OUT/run.txt"
+
+# Pinning QEMU to HOST_CPUS keeps other work on the host off the guest's vCPUs
+taskset=""
+if [ -n "$HOST_CPUS" ]; then
+    taskset="taskset -c $HOST_CPUS"
+fi
+
+# $numa and $taskset are lists of arguments, so they are left unquoted on purpose
+$taskset vng --run "$KSRC" --user root --cpus "$CPUS" --memory "${MEM_MB}M" $numa \
+    --rwdir "$OUT" --exec "$REPO/vm/guest-bench.sh '$REPO' '$OUT' $BENCH_ARGS"
+
+echo "run-bench: results in $OUT"